@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace lwip::bench
+{
+	/// @brief 阻止编译器把结果未被使用的计算优化掉。
+	/// @param value
+	template <typename T>
+	inline void DoNotOptimize(T const &value)
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	/// @brief 重复执行 func, 直到累计运行时间不少于 min_duration.
+	/// @note 先执行一次作为预热，不计入结果。
+	/// @param func
+	/// @param min_duration
+	/// @return 平均每次执行的纳秒数。
+	inline double MeasureNanoseconds(std::function<void()> const &func,
+									 std::chrono::nanoseconds min_duration = std::chrono::milliseconds{200})
+	{
+		func();
+
+		uint64_t count = 0;
+		uint64_t batch = 1;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::nanoseconds elapsed{0};
+		while (elapsed < min_duration)
+		{
+			for (uint64_t i = 0; i < batch; i++)
+			{
+				func();
+			}
+
+			count += batch;
+			batch *= 2;
+			elapsed = std::chrono::steady_clock::now() - start;
+		}
+
+		return static_cast<double>(elapsed.count()) / static_cast<double>(count);
+	}
+
+	/// @brief 打印一行结果。
+	/// @param name
+	/// @param value
+	/// @param unit
+	inline void Report(std::string const &name, double value, std::string const &unit)
+	{
+		std::printf("%-48s %12.3f %s\n", name.c_str(), value, unit.c_str());
+	}
+} // namespace lwip::bench
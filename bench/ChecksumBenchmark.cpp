@@ -0,0 +1,61 @@
+#include "BenchHelper.h"
+#include "ReferenceChecksum.h"
+#include "lwip-wrapper/lwip_chksum.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+	/// @brief 把字节数和每次的纳秒数换算成 GB/s.
+	double GigabytesPerSecond(int length, double nanoseconds)
+	{
+		return static_cast<double>(length) / nanoseconds;
+	}
+} // namespace
+
+int main()
+{
+	std::vector<uint8_t> source(65536 + 1);
+	std::vector<uint8_t> destination(65536 + 1);
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		source[i] = static_cast<uint8_t>(i * 131 + 7);
+	}
+
+	for (int length : {64, 576, 1500, 9000, 65535})
+	{
+		// 奇数起始地址是 lwip 拷贝 pbuf 时常见的情况，单独测一次。
+		for (int offset : {0, 1})
+		{
+			uint8_t const *data = source.data() + offset;
+			std::string suffix = " len=" + std::to_string(length) + " offset=" + std::to_string(offset);
+
+			double reference_ns = lwip::bench::MeasureNanoseconds(
+				[&]()
+				{
+					lwip::bench::DoNotOptimize(lwip::test::lwip_standard_chksum(data, length));
+				});
+
+			double wrapper_ns = lwip::bench::MeasureNanoseconds(
+				[&]()
+				{
+					lwip::bench::DoNotOptimize(lwip_wrapper_chksum(data, length));
+				});
+
+			double copy_ns = lwip::bench::MeasureNanoseconds(
+				[&]()
+				{
+					lwip::bench::DoNotOptimize(lwip_wrapper_chksum_copy(destination.data() + offset,
+																		data,
+																		static_cast<uint16_t>(length)));
+				});
+
+			lwip::bench::Report("lwip_standard_chksum" + suffix, GigabytesPerSecond(length, reference_ns), "GB/s");
+			lwip::bench::Report("lwip_wrapper_chksum" + suffix, GigabytesPerSecond(length, wrapper_ns), "GB/s");
+			lwip::bench::Report("lwip_wrapper_chksum_copy" + suffix, GigabytesPerSecond(length, copy_ns), "GB/s");
+		}
+	}
+
+	return 0;
+}
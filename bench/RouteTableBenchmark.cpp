@@ -0,0 +1,118 @@
+#include "BenchHelper.h"
+#include "lwip-wrapper/RouteTable.h"
+#include "lwip/def.h"
+#include "lwip/netif.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	/// @brief 线性扫描所有路由，取最长前缀。作为对照，相当于逐个网卡比较子网。
+	class LinearRoute
+	{
+	public:
+		uint32_t _network = 0;
+		uint32_t _mask = 0;
+		int32_t _prefix_length = 0;
+		netif *_netif = nullptr;
+	};
+
+	netif *LinearFind(std::vector<LinearRoute> const &routes, uint32_t destination)
+	{
+		LinearRoute const *best = nullptr;
+		for (LinearRoute const &route : routes)
+		{
+			if ((destination & route._mask) == route._network &&
+				(best == nullptr || route._prefix_length > best->_prefix_length))
+			{
+				best = &route;
+			}
+		}
+
+		return best != nullptr ? best->_netif : nullptr;
+	}
+
+	uint32_t Mask(int32_t prefix_length)
+	{
+		return prefix_length == 0 ? 0 : ~uint32_t{0} << (32 - prefix_length);
+	}
+
+	ip4_addr_t ToIp4Addr(uint32_t host_order_address)
+	{
+		ip4_addr_t address{};
+		ip4_addr_set_u32(&address, lwip_htonl(host_order_address));
+		return address;
+	}
+} // namespace
+
+int main()
+{
+	// 查找时只检查出口网卡的标志位，不需要启动协议栈。
+	std::vector<std::unique_ptr<netif>> netifs;
+	for (int i = 0; i < 4; i++)
+	{
+		std::unique_ptr<netif> net_interface{new netif{}};
+		net_interface->flags = NETIF_FLAG_UP | NETIF_FLAG_LINK_UP;
+		netifs.push_back(std::move(net_interface));
+	}
+
+	for (int route_count : {8, 64, 512, 4096})
+	{
+		std::mt19937 random{static_cast<uint32_t>(route_count)};
+		lwip::RouteTable table{};
+		std::vector<LinearRoute> linear_routes;
+
+		// 前缀长度分布在 /8 到 /32 之间，大部分是 /24.
+		for (int i = 0; i < route_count; i++)
+		{
+			int32_t prefix_length = i % 4 == 0 ? 8 + static_cast<int32_t>(random() % 25) : 24;
+			uint32_t network = (0x0a000000 | (random() & 0x00ffffff)) & Mask(prefix_length);
+			netif *net_interface = netifs[random() % netifs.size()].get();
+
+			table.Add(ToIp4Addr(network), prefix_length, ToIp4Addr(0), net_interface);
+			linear_routes.push_back(LinearRoute{network, Mask(prefix_length), prefix_length, net_interface});
+		}
+
+		// 一半目的地址落在某条路由中，另一半随机。
+		std::vector<ip4_addr_t> destinations;
+		std::vector<uint32_t> host_order_destinations;
+		for (int i = 0; i < 1024; i++)
+		{
+			uint32_t destination = random();
+			if (i % 2 == 0)
+			{
+				LinearRoute const &route = linear_routes[random() % linear_routes.size()];
+				destination = route._network | (random() & ~route._mask);
+			}
+
+			destinations.push_back(ToIp4Addr(destination));
+			host_order_destinations.push_back(destination);
+		}
+
+		double table_ns = lwip::bench::MeasureNanoseconds(
+			[&]()
+			{
+				for (ip4_addr_t const &destination : destinations)
+				{
+					lwip::bench::DoNotOptimize(table.FindNetif(&destination));
+				}
+			});
+
+		double linear_ns = lwip::bench::MeasureNanoseconds(
+			[&]()
+			{
+				for (uint32_t destination : host_order_destinations)
+				{
+					lwip::bench::DoNotOptimize(LinearFind(linear_routes, destination));
+				}
+			});
+
+		std::string suffix = " routes=" + std::to_string(table.Count());
+		lwip::bench::Report("RouteTable::FindNetif" + suffix, table_ns / destinations.size(), "ns/lookup");
+		lwip::bench::Report("linear scan" + suffix, linear_ns / destinations.size(), "ns/lookup");
+	}
+
+	return 0;
+}
@@ -0,0 +1,225 @@
+#include "BenchHelper.h"
+#include "lwip/opt.h"
+#include <cstdio>
+
+#if LWIP_SOCKET && LWIP_HAVE_LOOPIF
+	#include "base/task/delay.h"
+	#include "EthernetFrame.h"
+	#include "InMemoryEthernetPort.h"
+	#include "lwip-wrapper/NetifWrapper.h"
+	#include "lwip-wrapper/TcpConnection.h"
+	#include "lwip-wrapper/TcpIpCall.h"
+	#include "lwip-wrapper/TcpListener.h"
+	#include "lwip/sockets.h"
+	#include <atomic>
+	#include <chrono>
+	#include <memory>
+	#include <thread>
+	#include <vector>
+
+namespace
+{
+	constexpr int32_t ChunkSize = 16 * 1024;
+	constexpr int64_t TotalSize = 256ll * 1024 * 1024;
+
+	/// @brief 原始 API 的客户端同时在途的写入个数。
+	constexpr int32_t WritesInFlight = 4;
+
+	constexpr uint16_t RawApiPort = 7000;
+	constexpr uint16_t SocketPort = 7001;
+	std::array<uint8_t, 4> const LoopbackIPAddress{127, 0, 0, 1};
+
+	void WaitForReceiving(std::atomic_int64_t const &received_size)
+	{
+		while (received_size < TotalSize)
+		{
+			base::task::Delay(std::chrono::milliseconds{1});
+		}
+	}
+
+	double MegabytesPerSecond(std::chrono::nanoseconds elapsed)
+	{
+		return static_cast<double>(TotalSize) * 1e3 / static_cast<double>(elapsed.count());
+	}
+
+	/// @brief 原始 API 的客户端。在写入的完成回调中续写，不拷贝，也不经过邮箱。
+	class RawApiSender
+	{
+	private:
+		std::shared_ptr<lwip::TcpConnection> _connection{new lwip::TcpConnection{}};
+		std::vector<uint8_t> _buffer = std::vector<uint8_t>(ChunkSize, 0x5a);
+		int64_t _queued_size = 0;
+
+		void WriteNext()
+		{
+			if (_queued_size >= TotalSize)
+			{
+				return;
+			}
+
+			_queued_size += ChunkSize;
+			_connection->Write(base::ReadOnlySpan{_buffer.data(), ChunkSize},
+							   [this](bool succeeded)
+							   {
+								   if (succeeded)
+								   {
+									   WriteNext();
+								   }
+							   });
+		}
+
+	public:
+		/// @brief 连接并开始发送。需要在 lwip 内核上下文中调用。
+		void Start()
+		{
+			_connection->Connect(lwip::test::MakeIPAddress(LoopbackIPAddress),
+								 RawApiPort,
+								 [this](bool connected)
+								 {
+									 for (int32_t i = 0; connected && i < WritesInFlight; i++)
+									 {
+										 WriteNext();
+									 }
+								 });
+		}
+
+		/// @brief 需要在 lwip 内核上下文中调用。
+		void Stop()
+		{
+			_connection->Abort();
+		}
+	};
+
+	double BenchmarkRawApi()
+	{
+		std::atomic_int64_t received_size = 0;
+		std::shared_ptr<lwip::TcpConnection> server_connection;
+		lwip::TcpListener listener{};
+		RawApiSender sender{};
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		lwip::TcpIpCall(
+			[&]()
+			{
+				listener.Listen(lwip::test::MakeIPAddress(LoopbackIPAddress),
+								RawApiPort,
+								1,
+								[&](std::shared_ptr<lwip::TcpConnection> connection)
+								{
+									server_connection = connection;
+									connection->SetReceivingCallback(
+										[&](lwip::PbufChain chain)
+										{
+											received_size += chain.Size();
+											chain.Release();
+										});
+								});
+
+				sender.Start();
+			});
+
+		WaitForReceiving(received_size);
+		std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+
+		lwip::TcpIpCall(
+			[&]()
+			{
+				sender.Stop();
+				if (server_connection != nullptr)
+				{
+					server_connection->Abort();
+				}
+
+				listener.Stop();
+			});
+
+		return MegabytesPerSecond(elapsed);
+	}
+
+	double BenchmarkSocket()
+	{
+		sockaddr_in address{};
+		address.sin_len = sizeof(address);
+		address.sin_family = AF_INET;
+		address.sin_port = lwip_htons(SocketPort);
+		address.sin_addr.s_addr = lwip_htonl(INADDR_LOOPBACK);
+
+		int listening_socket = lwip_socket(AF_INET, SOCK_STREAM, 0);
+		lwip_bind(listening_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+		lwip_listen(listening_socket, 1);
+
+		std::atomic_int64_t received_size = 0;
+		std::thread receiving_thread{
+			[&]()
+			{
+				int connected_socket = lwip_accept(listening_socket, nullptr, nullptr);
+				std::vector<uint8_t> buffer(64 * 1024);
+				while (received_size < TotalSize)
+				{
+					int result = lwip_recv(connected_socket, buffer.data(), buffer.size(), 0);
+					if (result <= 0)
+					{
+						break;
+					}
+
+					received_size += result;
+				}
+
+				lwip_close(connected_socket);
+			},
+		};
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		int sending_socket = lwip_socket(AF_INET, SOCK_STREAM, 0);
+		lwip_connect(sending_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+
+		// lwip_send 把数据拷贝进发送缓冲区，每次调用都经过 tcpip 线程。
+		std::vector<uint8_t> buffer(ChunkSize, 0x5a);
+		for (int64_t sent_size = 0; sent_size < TotalSize;)
+		{
+			int result = lwip_send(sending_socket, buffer.data(), buffer.size(), 0);
+			if (result <= 0)
+			{
+				break;
+			}
+
+			sent_size += result;
+		}
+
+		receiving_thread.join();
+		std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+
+		lwip_close(sending_socket);
+		lwip_close(listening_socket);
+		return MegabytesPerSecond(elapsed);
+	}
+} // namespace
+
+int main()
+{
+	// 打开一张网卡来初始化协议栈，数据走 lwip 的回环网卡。
+	lwip::test::InMemoryEthernetPort port{};
+	lwip::NetifWrapper netif{"tcp-bench"};
+	netif.Open(&port,
+			   lwip::test::MakeMac({0x02, 0x00, 0x00, 0x00, 0x03, 0x01}),
+			   lwip::test::MakeIPAddress({192, 168, 103, 1}),
+			   lwip::test::MakeIPAddress({255, 255, 255, 0}),
+			   lwip::test::MakeIPAddress({192, 168, 103, 254}),
+			   1500);
+
+	lwip::bench::Report("TcpConnection (raw API, zero copy)", BenchmarkRawApi(), "MB/s");
+	lwip::bench::Report("lwip socket", BenchmarkSocket(), "MB/s");
+
+	netif.Dispose();
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::printf("需要在 lwipopts.h 中开启 LWIP_SOCKET 和 LWIP_HAVE_LOOPIF.\n");
+	return 0;
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "BenchHelper.h"
+#include "EthernetFrame.h"
+#include "InMemoryEthernetPort.h"
+#include "lwip-wrapper/NetifWrapper.h"
+#include "lwip-wrapper/UdpEndpoint.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::array<uint8_t, 6> const LocalMac{0x02, 0x00, 0x00, 0x00, 0x02, 0x01};
+	std::array<uint8_t, 6> const RemoteMac{0x02, 0x00, 0x00, 0x00, 0x02, 0x02};
+	std::array<uint8_t, 4> const LocalIPAddress{192, 168, 102, 1};
+	std::array<uint8_t, 4> const RemoteIPAddress{192, 168, 102, 2};
+	constexpr uint16_t LocalPort = 5000;
+	constexpr uint16_t RemotePort = 6000;
+	constexpr int32_t PayloadSize = 64;
+
+	/// @brief 发送方向：每批的数据报个数不同时，每秒发送到端口上的帧数。
+	/// @note 每批 1 个相当于逐个调用 udp_sendto, 每个数据报都要进入一次内核上下文。
+	void BenchmarkSending(lwip::UdpEndpoint &endpoint)
+	{
+		std::vector<uint8_t> payload(PayloadSize, 0x5a);
+		for (int batch_size : {1, 8, 32})
+		{
+			std::vector<lwip::UdpDatagram> datagrams;
+			for (int i = 0; i < batch_size; i++)
+			{
+				lwip::UdpDatagram datagram{};
+				datagram._remote_ip_address = lwip::test::MakeIPAddress(RemoteIPAddress);
+				datagram._remote_port = RemotePort;
+				datagram._payload = base::ReadOnlySpan{payload.data(), PayloadSize};
+				datagrams.push_back(datagram);
+			}
+
+			double ns = lwip::bench::MeasureNanoseconds(
+				[&]()
+				{
+					endpoint.SendBatch(datagrams);
+				},
+				std::chrono::seconds{1});
+
+			lwip::bench::Report("UdpEndpoint::SendBatch batch=" + std::to_string(batch_size),
+								batch_size * 1e3 / ns,
+								"Mpps");
+		}
+	}
+
+	/// @brief 接收方向：一个线程以最快的速度向端口注入帧，测量应用每秒取出的数据报个数。
+	void BenchmarkReceiving(lwip::test::InMemoryEthernetPort &port, lwip::UdpEndpoint &endpoint)
+	{
+		std::vector<uint8_t> frame = lwip::test::BuildUdpFrame(LocalMac,
+															   RemoteMac,
+															   RemoteIPAddress,
+															   LocalIPAddress,
+															   RemotePort,
+															   LocalPort,
+															   PayloadSize);
+
+		std::atomic_bool stopped = false;
+		std::thread injecting_thread{
+			[&]()
+			{
+				while (!stopped)
+				{
+					port.Receive(base::ReadOnlySpan{frame.data(), static_cast<int32_t>(frame.size())});
+				}
+			},
+		};
+
+		uint64_t received_count = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::nanoseconds elapsed{0};
+		while (elapsed < std::chrono::seconds{1})
+		{
+			received_count += endpoint.ReceiveBatch(64,
+													[](lwip::UdpDatagram const &datagram)
+													{
+														lwip::bench::DoNotOptimize(datagram._payload.Size());
+													});
+
+			elapsed = std::chrono::steady_clock::now() - start;
+		}
+
+		stopped = true;
+		injecting_thread.join();
+
+		lwip::bench::Report("UdpEndpoint::ReceiveBatch max_count=64",
+							static_cast<double>(received_count) * 1e3 / static_cast<double>(elapsed.count()),
+							"Mpps");
+
+		lwip::bench::Report("  dropped by the receiving ring",
+							static_cast<double>(endpoint.Statistics().dropped_datagram_count),
+							"datagrams");
+	}
+} // namespace
+
+int main()
+{
+	lwip::test::InMemoryEthernetPort port{};
+	lwip::NetifWrapper netif{"pps"};
+	netif.Open(&port,
+			   lwip::test::MakeMac(LocalMac),
+			   lwip::test::MakeIPAddress(LocalIPAddress),
+			   lwip::test::MakeIPAddress({255, 255, 255, 0}),
+			   lwip::test::MakeIPAddress({192, 168, 102, 254}),
+			   1500);
+
+	port.LinkUp();
+
+	// 固定的 ARP 表项，发送时不用等待 ARP 解析。
+	netif.AddStaticArpEntry(lwip::test::MakeIPAddress(RemoteIPAddress), lwip::test::MakeMac(RemoteMac));
+
+	{
+		lwip::UdpEndpoint endpoint{};
+		endpoint.Bind(lwip::test::MakeIPAddress(LocalIPAddress), LocalPort);
+		BenchmarkSending(endpoint);
+		BenchmarkReceiving(port, endpoint);
+	}
+
+	netif.Dispose();
+	return 0;
+}
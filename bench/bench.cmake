@@ -0,0 +1,17 @@
+# 性能测试。每个性能测试是一个独立的可执行文件，把结果打印到标准输出，不注册到 ctest.
+# 测量性能时应使用 Release 构建。
+set(LWIP_WRAPPER_BENCH_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+add_custom_target(lwip-wrapper-bench)
+
+function(lwip_wrapper_add_benchmark name)
+	add_executable(${name} ${LWIP_WRAPPER_BENCH_DIR}/${name}.cpp)
+	target_link_libraries(${name} PRIVATE ${ProjectName})
+	target_include_directories(${name} PRIVATE ${LWIP_WRAPPER_BENCH_DIR} ${LWIP_WRAPPER_BENCH_DIR}/../test)
+	add_dependencies(lwip-wrapper-bench ${name})
+endfunction()
+
+lwip_wrapper_add_benchmark(ChecksumBenchmark)
+lwip_wrapper_add_benchmark(RouteTableBenchmark)
+lwip_wrapper_add_benchmark(UdpPpsBenchmark)
+lwip_wrapper_add_benchmark(TcpThroughputBenchmark)
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace lwip
+{
+	/// @brief 聚合网卡在多个成员端口之间分配发送流量时使用的流哈希策略。
+	/// @note 同一条流的帧总是经同一个成员端口发出，所以不会乱序。
+	enum class BondingHashPolicy
+	{
+		/// @brief 按源 MAC 地址和目的 MAC 地址进行哈希。
+		L2,
+
+		/// @brief 按源 IP 地址和目的 IP 地址进行哈希。非 IPv4 帧退化为 L2.
+		L3,
+
+		/// @brief 按源 IP 地址、目的 IP 地址以及 TCP/UDP 端口号进行哈希。
+		/// @note 分片的 IPv4 报文和非 TCP/UDP 报文退化为 L3, 非 IPv4 帧退化为 L2.
+		L3L4,
+	};
+} // namespace lwip
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+
+namespace lwip
+{
+	/// @brief 聚合网卡中单个成员端口的统计数据。
+	class BondingMemberStatistics
+	{
+	public:
+		/// @brief 该成员端口当前的链路是否接通。
+		bool link_up = false;
+
+		/// @brief 经该成员端口发送的帧数。
+		uint64_t sent_frame_count = 0;
+
+		/// @brief 经该成员端口发送的字节数。
+		uint64_t sent_byte_count = 0;
+
+		/// @brief 该成员端口发送失败的次数。
+		uint64_t sending_error_count = 0;
+
+		/// @brief 从该成员端口接收到的帧数。
+		uint64_t received_frame_count = 0;
+
+		/// @brief 从该成员端口接收到的字节数。
+		uint64_t received_byte_count = 0;
+
+		/// @brief 该成员端口链路断开的次数。
+		uint64_t link_down_count = 0;
+	};
+} // namespace lwip
@@ -0,0 +1,262 @@
+#include "Bridge.h"
+#include "base/string/define.h"
+#include "lwip-wrapper/NetifWrapper.h"
+#include "lwip/sys.h"
+#include <cstring>
+
+namespace
+{
+	constexpr int32_t _ethernet_header_size = 14;
+
+	/// @brief 检查是否是组播地址或广播地址。
+	/// @param mac
+	/// @return
+	bool IsGroupAddress(uint8_t const *mac)
+	{
+		return (mac[0] & 0x01) != 0;
+	}
+
+	bool IsMacOf(lwip::NetifWrapper const *netif_wrapper, uint8_t const *mac)
+	{
+		return std::memcmp(netif_wrapper->WrappedObj()->hwaddr, mac, 6) == 0;
+	}
+} // namespace
+
+int32_t lwip::Bridge::IndexOf(lwip::NetifWrapper const *netif_wrapper) const
+{
+	for (uint32_t i = 0; i < _max_port_count; i++)
+	{
+		if (_ports[i].load(std::memory_order_acquire) == netif_wrapper)
+		{
+			return static_cast<int32_t>(i);
+		}
+	}
+
+	return -1;
+}
+
+lwip::NetifWrapper *lwip::Bridge::FindLocalNetif(uint8_t const *mac) const
+{
+	for (std::atomic<lwip::NetifWrapper *> const &port : _ports)
+	{
+		lwip::NetifWrapper *netif_wrapper = port.load(std::memory_order_acquire);
+		if (netif_wrapper != nullptr && IsMacOf(netif_wrapper, mac))
+		{
+			return netif_wrapper;
+		}
+	}
+
+	return nullptr;
+}
+
+void lwip::Bridge::Flood(int32_t ingress_index, base::ReadOnlySpan const &frame)
+{
+	for (int32_t i = 0; i < static_cast<int32_t>(_max_port_count); i++)
+	{
+		if (i == ingress_index)
+		{
+			continue;
+		}
+
+		lwip::NetifWrapper *egress = _ports[i].load(std::memory_order_acquire);
+		if (egress != nullptr)
+		{
+			Forward(egress, frame);
+		}
+	}
+}
+
+void lwip::Bridge::Forward(lwip::NetifWrapper *egress, base::ReadOnlySpan const &frame)
+{
+	try
+	{
+		egress->SendFrame(frame);
+	}
+	catch (std::exception const &e)
+	{
+		// 转发失败就丢弃，与交换机的行为一致，不能影响入口网卡的接收。
+	}
+}
+
+void lwip::Bridge::ForwardOutput(lwip::NetifWrapper *egress,
+								 std::vector<base::ReadOnlySpan> const &spans,
+								 int32_t size)
+{
+	try
+	{
+		egress->OutputFromBridge(spans, size);
+	}
+	catch (std::exception const &e)
+	{
+		// 与转发一样，某个端口发送失败不影响其他端口。
+	}
+}
+
+lwip::Bridge::Bridge(uint32_t mac_table_capacity, uint32_t aging_time)
+	: _mac_table(mac_table_capacity, aging_time)
+{
+}
+
+void lwip::Bridge::AddPort(lwip::NetifWrapper *netif_wrapper)
+{
+	if (netif_wrapper == nullptr)
+	{
+		throw std::invalid_argument{CODE_POS_STR + "禁止传入空指针。"};
+	}
+
+	if (IndexOf(netif_wrapper) >= 0)
+	{
+		return;
+	}
+
+	for (std::atomic<lwip::NetifWrapper *> &port : _ports)
+	{
+		lwip::NetifWrapper *expected = nullptr;
+		if (port.compare_exchange_strong(expected, netif_wrapper))
+		{
+			return;
+		}
+	}
+
+	throw std::runtime_error{CODE_POS_STR + "网桥端口已满。"};
+}
+
+void lwip::Bridge::RemovePort(lwip::NetifWrapper *netif_wrapper)
+{
+	int32_t index = IndexOf(netif_wrapper);
+	if (index < 0)
+	{
+		return;
+	}
+
+	_ports[index].store(nullptr, std::memory_order_release);
+
+	// 等待已经读到这张网卡的接收线程离开，之后调用者才能释放网卡。
+	_grace_period.Synchronize();
+
+	// 端口号会被别的网卡复用，必须把旧的表项作废。
+	_mac_table.Forget(static_cast<uint16_t>(index));
+}
+
+bool lwip::Bridge::Input(lwip::NetifWrapper *ingress, base::ReadOnlySpan const &frame)
+{
+	if (frame.Size() < _ethernet_header_size)
+	{
+		// 交给 lwip 丢弃。
+		return true;
+	}
+
+	// 直到返回都不会有端口上的网卡被释放。
+	lwip::GracePeriod::ReadGuard g{_grace_period};
+
+	int32_t ingress_index = IndexOf(ingress);
+	if (ingress_index < 0)
+	{
+		return true;
+	}
+
+	uint8_t const *destination = frame.Buffer();
+	uint8_t const *source = frame.Buffer() + 6;
+	uint32_t now = sys_now();
+
+	// 源地址是本机网卡的帧是环路回来的，不能学习，否则会把本机地址学到错误的端口上。
+	if (!IsGroupAddress(source) && FindLocalNetif(source) == nullptr)
+	{
+		_mac_table.Learn(source, static_cast<uint16_t>(ingress_index), now);
+	}
+
+	if (IsGroupAddress(destination))
+	{
+		Flood(ingress_index, frame);
+		return true;
+	}
+
+	if (IsMacOf(ingress, destination))
+	{
+		return true;
+	}
+
+	lwip::NetifWrapper *local_netif = FindLocalNetif(destination);
+	if (local_netif != nullptr)
+	{
+		// 发给网桥上另一张本机网卡的帧，直接输入那张网卡。
+		local_netif->InputFrame(frame);
+		return false;
+	}
+
+	int32_t egress_index = _mac_table.Find(destination, now);
+	if (egress_index == ingress_index)
+	{
+		// 目的主机与源主机在同一侧，不需要转发。
+		return false;
+	}
+
+	if (egress_index >= 0)
+	{
+		lwip::NetifWrapper *egress = _ports[egress_index].load(std::memory_order_acquire);
+		if (egress != nullptr)
+		{
+			Forward(egress, frame);
+			return false;
+		}
+	}
+
+	// 未知的单播地址，泛洪。
+	Flood(ingress_index, frame);
+	return false;
+}
+
+bool lwip::Bridge::Output(lwip::NetifWrapper *source, std::vector<base::ReadOnlySpan> const &spans, int32_t size)
+{
+	if (spans.empty() || spans[0].Size() < _ethernet_header_size)
+	{
+		return false;
+	}
+
+	lwip::GracePeriod::ReadGuard g{_grace_period};
+
+	if (IndexOf(source) < 0)
+	{
+		return false;
+	}
+
+	uint8_t const *destination = spans[0].Buffer();
+	if (!IsGroupAddress(destination))
+	{
+		lwip::NetifWrapper *local_netif = FindLocalNetif(destination);
+		if (local_netif == source)
+		{
+			// 发给自己的帧 lwip 不会走到 linkoutput, 这里保持原来的行为。
+			return false;
+		}
+
+		if (local_netif != nullptr)
+		{
+			local_netif->InputCopiedFrame(spans, size);
+			return true;
+		}
+
+		int32_t egress_index = _mac_table.Find(destination, sys_now());
+		if (egress_index >= 0)
+		{
+			lwip::NetifWrapper *egress = _ports[egress_index].load(std::memory_order_acquire);
+			if (egress != nullptr)
+			{
+				ForwardOutput(egress, spans, size);
+				return true;
+			}
+		}
+	}
+
+	// 广播帧、组播帧和未知的单播帧，泛洪到所有端口。
+	for (std::atomic<lwip::NetifWrapper *> const &port : _ports)
+	{
+		lwip::NetifWrapper *egress = port.load(std::memory_order_acquire);
+		if (egress != nullptr)
+		{
+			ForwardOutput(egress, spans, size);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "base/define.h"
+#include "base/net/Mac.h"
+#include "lwip-wrapper/GracePeriod.h"
+#include "lwip-wrapper/MacLearningTable.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace lwip
+{
+	class NetifWrapper;
+
+	/// @brief 在多张网卡之间进行二层转发的软件网桥。
+	/// @note 网卡接收到帧后，在接收线程中直接查 MAC 地址学习表，把帧原样交给出口网卡发送，
+	/// 不经过 lwip 协议栈，也不拷贝帧。只有目的 MAC 地址是本机网卡的单播帧，以及广播帧、
+	/// 组播帧才会输入 lwip.
+	///
+	/// @note 本类不拥有网卡，由 NetifSlot 负责添加和移除端口。接收线程在读临界区中使用端口，
+	/// RemovePort 等待这些线程离开后才返回，之后网卡才可以被释放。
+	class Bridge
+	{
+	private:
+		DELETE_COPY_AND_MOVE(Bridge)
+
+		static constexpr uint32_t _max_port_count = 8;
+
+		std::array<std::atomic<lwip::NetifWrapper *>, _max_port_count> _ports{};
+
+		/// @brief 访问 _ports 中的网卡的线程都在读临界区中。
+		lwip::GracePeriod _grace_period;
+		lwip::MacLearningTable _mac_table;
+
+		/// @brief 查找网卡所在的端口号。
+		/// @param netif_wrapper
+		/// @return 找不到返回 -1.
+		int32_t IndexOf(lwip::NetifWrapper const *netif_wrapper) const;
+
+		/// @brief 查找 MAC 地址属于哪张本机网卡。
+		/// @param mac
+		/// @return 找不到返回空指针。
+		lwip::NetifWrapper *FindLocalNetif(uint8_t const *mac) const;
+
+		/// @brief 把帧发到除入口以外的所有端口。
+		/// @param ingress_index
+		/// @param frame
+		void Flood(int32_t ingress_index, base::ReadOnlySpan const &frame);
+
+		void Forward(lwip::NetifWrapper *egress, base::ReadOnlySpan const &frame);
+
+		/// @brief 把本机协议栈发出的帧交给出口网卡发送。在 lwip 内核上下文中调用。
+		/// @param egress
+		/// @param spans
+		/// @param size
+		void ForwardOutput(lwip::NetifWrapper *egress, std::vector<base::ReadOnlySpan> const &spans, int32_t size);
+
+	public:
+		/// @brief 构造函数。
+		/// @param mac_table_capacity MAC 地址学习表的容量。
+		/// @param aging_time MAC 地址的老化时间，单位：毫秒。
+		Bridge(uint32_t mac_table_capacity = 256, uint32_t aging_time = 300 * 1000);
+
+		/// @brief 添加一个端口。
+		/// @param netif_wrapper
+		void AddPort(lwip::NetifWrapper *netif_wrapper);
+
+		/// @brief 移除一个端口。端口不存在则什么都不做。
+		/// @note 返回时已经没有线程在通过网桥使用这张网卡。
+		/// @warning 会等待其他网卡的接收线程，禁止在 lwip 内核上下文中调用。
+		/// @param netif_wrapper
+		void RemovePort(lwip::NetifWrapper *netif_wrapper);
+
+		/// @brief 处理端口接收到的帧。
+		/// @param ingress 接收到帧的网卡。
+		/// @param frame 以太网帧。
+		/// @return 需要将帧输入 ingress 的 lwip 协议栈则返回 true.
+		bool Input(lwip::NetifWrapper *ingress, base::ReadOnlySpan const &frame);
+
+		/// @brief 处理端口上的本机协议栈发出的帧。
+		/// @note 与 Input 一样查 MAC 地址学习表：已知的单播帧从学习到的端口发出，广播帧、组播帧
+		/// 和未知的单播帧泛洪到所有端口，包括 source 自己。发给网桥上另一张本机网卡的帧拷贝后
+		/// 输入那张网卡。
+		///
+		/// @note 在 linkoutput 中调用，此时处于 lwip 内核上下文。
+		///
+		/// @param source 发出帧的网卡。
+		/// @param spans 帧的各段。第一段包含以太网头。
+		/// @param size 帧的总字节数。
+		/// @return 网桥已经处理了这个帧则返回 true. 返回 false 时由 source 自己发送。
+		bool Output(lwip::NetifWrapper *source, std::vector<base::ReadOnlySpan> const &spans, int32_t size);
+	};
+} // namespace lwip
@@ -0,0 +1,41 @@
+#pragma once
+
+namespace lwip
+{
+	/// @brief 以太网端口的校验和卸载能力。
+	/// @note generation 表示发送时由硬件填写校验和，checking 表示接收时由硬件校验，并且
+	/// 硬件会丢弃校验失败的帧。被卸载的项目 lwip 就不再用软件计算。
+	class ChecksumOffloadCapability
+	{
+	public:
+		bool ip_generation = false;
+		bool ip_checking = false;
+
+		bool udp_generation = false;
+		bool udp_checking = false;
+
+		bool tcp_generation = false;
+		bool tcp_checking = false;
+
+		bool icmp_generation = false;
+		bool icmp_checking = false;
+
+		/// @brief 求交集。聚合网卡的帧可能从任意一个成员端口收发，所以只有所有成员都支持的
+		/// 项目才能卸载。
+		/// @param other
+		/// @return
+		ChecksumOffloadCapability Intersect(ChecksumOffloadCapability const &other) const
+		{
+			ChecksumOffloadCapability result{};
+			result.ip_generation = ip_generation && other.ip_generation;
+			result.ip_checking = ip_checking && other.ip_checking;
+			result.udp_generation = udp_generation && other.udp_generation;
+			result.udp_checking = udp_checking && other.udp_checking;
+			result.tcp_generation = tcp_generation && other.tcp_generation;
+			result.tcp_checking = tcp_checking && other.tcp_checking;
+			result.icmp_generation = icmp_generation && other.icmp_generation;
+			result.icmp_checking = icmp_checking && other.icmp_checking;
+			return result;
+		}
+	};
+} // namespace lwip
@@ -0,0 +1,17 @@
+#include "FrameTimestamp.h"
+#include "InputPbuf.h"
+
+lwip::FrameTimestamp lwip::FrameTimestamp::Now()
+{
+	lwip::FrameTimestamp timestamp{};
+	timestamp._source = lwip::FrameTimestampSource::Software;
+	timestamp._time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch());
+
+	return timestamp;
+}
+
+bool lwip::TryGetFrameTimestamp(pbuf const *p, lwip::FrameTimestamp &timestamp)
+{
+	return lwip::InputPbuf::TryGetTimestamp(p, timestamp);
+}
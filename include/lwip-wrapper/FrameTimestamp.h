@@ -0,0 +1,46 @@
+#pragma once
+#include "lwip/pbuf.h"
+#include <chrono>
+
+namespace lwip
+{
+	/// @brief 时间戳的来源。
+	enum class FrameTimestampSource
+	{
+		/// @brief 没有时间戳。
+		None,
+
+		/// @brief 软件时钟。std::chrono::steady_clock 的纪元。
+		Software,
+
+		/// @brief 以太网端口的硬件时钟。纪元由端口决定。
+		Hardware,
+	};
+
+	/// @brief 以太网帧的接收或发送时间戳。
+	class FrameTimestamp
+	{
+	public:
+		lwip::FrameTimestampSource _source = lwip::FrameTimestampSource::None;
+		std::chrono::nanoseconds _time{0};
+
+		/// @brief 是否含有时间戳。
+		/// @return
+		bool IsValid() const
+		{
+			return _source != lwip::FrameTimestampSource::None;
+		}
+
+		/// @brief 用软件时钟获取当前时间。
+		/// @return
+		static lwip::FrameTimestamp Now();
+	};
+
+	/// @brief 读取 NetifWrapper 接收帧时记录在 pbuf 中的时间戳。
+	/// @note lwip 向上层交付数据时，pbuf 只是移动了负载指针，仍是接收时的那个 pbuf,
+	/// 所以 UDP 和 TCP 的接收回调拿到的 pbuf 也能读到时间戳。
+	/// @param p
+	/// @param timestamp
+	/// @return 没有开启时间戳，或者 pbuf 不是 NetifWrapper 接收时创建的，返回 false.
+	bool TryGetFrameTimestamp(pbuf const *p, lwip::FrameTimestamp &timestamp);
+} // namespace lwip
@@ -0,0 +1,69 @@
+#pragma once
+#include "base/define.h"
+#include "base/task/delay.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace lwip
+{
+	/// @brief 读者无锁的宽限期。
+	/// @note 读者用 ReadGuard 标出读临界区，进入和离开各是一次原子操作。写者先让读者看不到
+	/// 要回收的对象，再调用 Synchronize, 返回时在这之前进入临界区的读者都已离开，可以安全地
+	/// 回收。
+	///
+	/// @note 读者按进入时的纪元奇偶性登记在两个计数器中的一个上。读者读取纪元和登记之间可能
+	/// 被抢占，登记时纪元可能已经被翻转过，所以像两阶段的用户态 RCU 一样翻转两次，两个计数器
+	/// 都等待归零。
+	class GracePeriod
+	{
+	private:
+		DELETE_COPY_AND_MOVE(GracePeriod)
+
+		std::atomic_uint32_t _epoch = 0;
+		mutable std::array<std::atomic_uint32_t, 2> _reader_counts{};
+
+		/// @brief 翻转纪元，等待翻转前的奇偶性对应的计数器归零。
+		void FlipAndWait()
+		{
+			uint32_t old_parity = _epoch.fetch_add(1) & 1;
+			while (_reader_counts[old_parity].load() != 0)
+			{
+				base::task::Delay(std::chrono::milliseconds{1});
+			}
+		}
+
+	public:
+		GracePeriod() = default;
+
+		/// @brief 在作用域内处于读临界区。
+		class ReadGuard
+		{
+		private:
+			std::atomic_uint32_t &_reader_count;
+
+		public:
+			ReadGuard(GracePeriod const &grace_period)
+				: _reader_count(grace_period._reader_counts[grace_period._epoch.load() & 1])
+			{
+				_reader_count.fetch_add(1);
+			}
+
+			~ReadGuard()
+			{
+				_reader_count.fetch_sub(1);
+			}
+
+			DELETE_COPY_AND_MOVE(ReadGuard)
+		};
+
+		/// @brief 等待调用之前进入读临界区的读者全部离开。
+		/// @warning 禁止在读临界区中调用，否则会永远等待自己。
+		void Synchronize()
+		{
+			FlipAndWait();
+			FlipAndWait();
+		}
+	};
+} // namespace lwip
@@ -0,0 +1,20 @@
+#pragma once
+#include "lwip-wrapper/ChecksumOffloadCapability.h"
+
+namespace lwip
+{
+	/// @brief 支持校验和卸载的以太网端口需要额外实现的接口。
+	/// @note 以太网端口的类同时继承 base::ethernet::IEthernetPort 和本接口，NetifWrapper
+	/// 打开时就会查询卸载能力，并让 lwip 跳过硬件会处理的校验和。没有实现本接口的端口
+	/// 所有校验和都由 lwip 用软件计算。
+	class IChecksumOffload
+	{
+	public:
+		virtual ~IChecksumOffload() = default;
+
+		/// @brief 获取校验和卸载能力。
+		/// @note 在以太网端口的 Open 方法之后调用。
+		/// @return
+		virtual lwip::ChecksumOffloadCapability ChecksumOffloadCapability() const = 0;
+	};
+} // namespace lwip
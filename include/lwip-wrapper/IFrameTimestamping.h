@@ -0,0 +1,27 @@
+#pragma once
+#include <chrono>
+
+namespace lwip
+{
+	/// @brief 支持硬件时间戳的以太网端口需要额外实现的接口。
+	/// @note 以太网端口的类同时继承 base::ethernet::IEthernetPort 和本接口。NetifWrapper
+	/// 开启时间戳后优先使用硬件时间戳，没有实现本接口的端口，或者本接口返回 false 时，
+	/// 使用软件时钟。
+	class IFrameTimestamping
+	{
+	public:
+		virtual ~IFrameTimestamping() = default;
+
+		/// @brief 获取正在交付的帧的硬件接收时间戳。
+		/// @note 在 ReceivingEhternetFrameEvent 的回调中调用。
+		/// @param timestamp
+		/// @return 没有时间戳返回 false.
+		virtual bool TryGetReceivingTimestamp(std::chrono::nanoseconds &timestamp) = 0;
+
+		/// @brief 获取刚刚发送的帧的硬件发送时间戳。
+		/// @note 在 Send 方法返回后调用。
+		/// @param timestamp
+		/// @return 没有时间戳返回 false.
+		virtual bool TryGetSendingTimestamp(std::chrono::nanoseconds &timestamp) = 0;
+	};
+} // namespace lwip
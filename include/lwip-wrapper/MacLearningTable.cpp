@@ -0,0 +1,143 @@
+#include "MacLearningTable.h"
+
+uint64_t lwip::MacLearningTable::ToKey(uint8_t const *mac)
+{
+	uint64_t key = 0;
+	for (int i = 0; i < 6; i++)
+	{
+		key = (key << 8) | mac[i];
+	}
+
+	return key;
+}
+
+uint32_t lwip::MacLearningTable::HomeIndex(uint64_t key) const
+{
+	// MAC 地址的低位是网卡序号，高位是厂商代码，混合一下让低位的变化扩散开。
+	uint64_t hash = key * 0x9e3779b97f4a7c15ull;
+	return static_cast<uint32_t>(hash >> 32) & (_capacity - 1);
+}
+
+bool lwip::MacLearningTable::IsAlive(Entry const &entry, uint32_t now) const
+{
+	// 无符号减法，时间戳回绕后也能得到正确的间隔。
+	return now - entry._last_seen_time.load(std::memory_order_relaxed) <= _aging_time;
+}
+
+lwip::MacLearningTable::MacLearningTable(uint32_t capacity, uint32_t aging_time)
+{
+	_capacity = 1;
+	while (_capacity < capacity)
+	{
+		_capacity <<= 1;
+	}
+
+	_aging_time = aging_time;
+	_entries = std::unique_ptr<Entry[]>{new Entry[_capacity]{}};
+}
+
+void lwip::MacLearningTable::Learn(uint8_t const *mac, uint16_t port, uint32_t now)
+{
+	uint64_t key = ToKey(mac);
+	uint64_t value = key | (static_cast<uint64_t>(port + 1) << 48);
+	uint32_t index = HomeIndex(key);
+	Entry *reusable_entry = nullptr;
+
+	uint32_t probe_count = _max_probe_count < _capacity ? _max_probe_count : _capacity;
+	for (uint32_t i = 0; i < probe_count; i++)
+	{
+		Entry &entry = _entries[(index + i) & (_capacity - 1)];
+		uint64_t mac_and_port = entry._mac_and_port.load(std::memory_order_acquire);
+		if (mac_and_port == 0)
+		{
+			if (reusable_entry == nullptr)
+			{
+				reusable_entry = &entry;
+			}
+
+			// 空表项是探测链的终点，后面不会再有这个地址。
+			break;
+		}
+
+		if ((mac_and_port & 0xffffffffffffull) == key)
+		{
+			entry._last_seen_time.store(now, std::memory_order_relaxed);
+			if (mac_and_port != value)
+			{
+				// 主机换了端口。
+				entry._mac_and_port.store(value, std::memory_order_release);
+			}
+
+			return;
+		}
+
+		if (reusable_entry == nullptr && !IsAlive(entry, now))
+		{
+			reusable_entry = &entry;
+		}
+	}
+
+	if (reusable_entry == nullptr)
+	{
+		// 探测链上全是活跃的表项，放弃学习。找不到的地址会被泛洪，不影响正确性。
+		return;
+	}
+
+	reusable_entry->_last_seen_time.store(now, std::memory_order_relaxed);
+	reusable_entry->_mac_and_port.store(value, std::memory_order_release);
+}
+
+int32_t lwip::MacLearningTable::Find(uint8_t const *mac, uint32_t now) const
+{
+	uint64_t key = ToKey(mac);
+	uint32_t index = HomeIndex(key);
+
+	uint32_t probe_count = _max_probe_count < _capacity ? _max_probe_count : _capacity;
+	for (uint32_t i = 0; i < probe_count; i++)
+	{
+		Entry const &entry = _entries[(index + i) & (_capacity - 1)];
+		uint64_t mac_and_port = entry._mac_and_port.load(std::memory_order_acquire);
+		if (mac_and_port == 0)
+		{
+			return -1;
+		}
+
+		if ((mac_and_port & 0xffffffffffffull) == key)
+		{
+			if (!IsAlive(entry, now))
+			{
+				return -1;
+			}
+
+			return static_cast<int32_t>(mac_and_port >> 48) - 1;
+		}
+	}
+
+	return -1;
+}
+
+void lwip::MacLearningTable::Forget(uint16_t port)
+{
+	for (uint32_t i = 0; i < _capacity; i++)
+	{
+		Entry &entry = _entries[i];
+		uint64_t mac_and_port = entry._mac_and_port.load(std::memory_order_acquire);
+		if (mac_and_port != 0 && (mac_and_port >> 48) == static_cast<uint64_t>(port + 1))
+		{
+			/* 不能直接清 0, 否则会截断经过这个表项的探测链。把时间改成老化后的时间，
+			 * 让它失效，并可被重新利用。
+			 */
+			entry._last_seen_time.store(entry._last_seen_time.load(std::memory_order_relaxed) - _aging_time - 1,
+										std::memory_order_relaxed);
+		}
+	}
+}
+
+void lwip::MacLearningTable::Clear()
+{
+	for (uint32_t i = 0; i < _capacity; i++)
+	{
+		_entries[i]._mac_and_port.store(0, std::memory_order_release);
+		_entries[i]._last_seen_time.store(0, std::memory_order_relaxed);
+	}
+}
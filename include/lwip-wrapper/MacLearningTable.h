@@ -0,0 +1,68 @@
+#pragma once
+#include "base/define.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace lwip
+{
+	/// @brief 网桥的 MAC 地址学习表。
+	/// @note 固定容量的开放寻址哈希表，使用线性探测。表项超过老化时间没有被刷新就视为失效，
+	/// 失效的表项会被新学习到的地址覆盖。
+	///
+	/// @note 每个表项的 MAC 地址和端口号打包在同一个原子变量中，所以多个接收线程可以同时
+	/// 学习和查找，不需要加锁。
+	class MacLearningTable
+	{
+	private:
+		DELETE_COPY_AND_MOVE(MacLearningTable)
+
+		class Entry
+		{
+		public:
+			/// @brief 低 48 位是 MAC 地址，高 16 位是端口号加 1. 为 0 表示空表项。
+			std::atomic_uint64_t _mac_and_port = 0;
+
+			/// @brief 上次刷新的时间，单位：毫秒。
+			std::atomic_uint32_t _last_seen_time = 0;
+		};
+
+		std::unique_ptr<Entry[]> _entries;
+		uint32_t _capacity = 0;
+		uint32_t _aging_time = 0;
+
+		/// @brief 探测的最大长度。超过后放弃学习，或认为查找不到。
+		static constexpr uint32_t _max_probe_count = 16;
+
+		static uint64_t ToKey(uint8_t const *mac);
+
+		uint32_t HomeIndex(uint64_t key) const;
+
+		bool IsAlive(Entry const &entry, uint32_t now) const;
+
+	public:
+		/// @brief 构造函数。
+		/// @param capacity 表项个数。会向上取整到 2 的整数次幂。
+		/// @param aging_time 老化时间，单位：毫秒。
+		MacLearningTable(uint32_t capacity, uint32_t aging_time);
+
+		/// @brief 学习一个 MAC 地址。已经存在则刷新它的端口号和时间。
+		/// @param mac 6 字节的 MAC 地址，网络字节序。
+		/// @param port 端口号。
+		/// @param now 当前时间，单位：毫秒。
+		void Learn(uint8_t const *mac, uint16_t port, uint32_t now);
+
+		/// @brief 查找 MAC 地址所在的端口。
+		/// @param mac 6 字节的 MAC 地址，网络字节序。
+		/// @param now 当前时间，单位：毫秒。
+		/// @return 找不到或已老化返回 -1.
+		int32_t Find(uint8_t const *mac, uint32_t now) const;
+
+		/// @brief 删除指定端口学习到的所有地址。
+		/// @param port
+		void Forget(uint16_t port);
+
+		/// @brief 清空。
+		void Clear();
+	};
+} // namespace lwip
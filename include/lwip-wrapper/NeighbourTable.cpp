@@ -0,0 +1,195 @@
+#include "NeighbourTable.h"
+
+uint32_t lwip::NeighbourTable::HomeIndex(uint32_t ip) const
+{
+	// 同一个子网中的地址只有低位不同，乘法哈希把它们扩散到高位再取出。
+	uint32_t hash = ip * 0x9e3779b1u;
+	return (hash >> 16) & (_capacity - 1);
+}
+
+bool lwip::NeighbourTable::IsAlive(Entry const &entry, uint32_t now) const
+{
+	if (entry._is_static)
+	{
+		return true;
+	}
+
+	// 无符号减法，时间戳回绕后也能得到正确的间隔。
+	return now - entry._last_seen_time <= _aging_time;
+}
+
+int32_t lwip::NeighbourTable::IndexOf(uint32_t ip) const
+{
+	uint32_t index = HomeIndex(ip);
+	for (uint32_t i = 0; i < _max_probe_count && i < _capacity; i++)
+	{
+		uint32_t position = (index + i) & (_capacity - 1);
+		Entry const &entry = _entries[position];
+		if (entry._ip == 0)
+		{
+			return -1;
+		}
+
+		if (entry._ip == ip)
+		{
+			return static_cast<int32_t>(position);
+		}
+	}
+
+	return -1;
+}
+
+lwip::NeighbourTable::NeighbourTable(uint32_t capacity, uint32_t aging_time)
+{
+	_capacity = 1;
+	while (_capacity < capacity)
+	{
+		_capacity <<= 1;
+	}
+
+	_aging_time = aging_time;
+	_entries = std::unique_ptr<Entry[]>{new Entry[_capacity]{}};
+}
+
+void lwip::NeighbourTable::Learn(ip4_addr_t const &ip, eth_addr const &mac, uint32_t now, bool is_static)
+{
+	uint32_t key = ip4_addr_get_u32(&ip);
+	if (key == 0)
+	{
+		return;
+	}
+
+	uint32_t index = HomeIndex(key);
+	Entry *reusable_entry = nullptr;
+	Entry *oldest_entry = nullptr;
+	for (uint32_t i = 0; i < _max_probe_count && i < _capacity; i++)
+	{
+		Entry &entry = _entries[(index + i) & (_capacity - 1)];
+		if (entry._ip == key)
+		{
+			if (entry._is_static && !is_static)
+			{
+				return;
+			}
+
+			entry._mac = mac;
+			entry._is_static = is_static;
+			entry._last_seen_time = now;
+			return;
+		}
+
+		if (entry._ip == 0)
+		{
+			if (reusable_entry == nullptr)
+			{
+				reusable_entry = &entry;
+			}
+
+			// 空表项是探测链的终点。
+			break;
+		}
+
+		if (reusable_entry == nullptr && !IsAlive(entry, now))
+		{
+			reusable_entry = &entry;
+		}
+
+		if (!entry._is_static &&
+			(oldest_entry == nullptr || now - entry._last_seen_time > now - oldest_entry->_last_seen_time))
+		{
+			oldest_entry = &entry;
+		}
+	}
+
+	if (reusable_entry == nullptr)
+	{
+		if (oldest_entry == nullptr)
+		{
+			// 探测窗口内全是静态表项。
+			return;
+		}
+
+		reusable_entry = oldest_entry;
+		_eviction_count++;
+	}
+
+	reusable_entry->_ip = key;
+	reusable_entry->_mac = mac;
+	reusable_entry->_is_static = is_static;
+	reusable_entry->_last_seen_time = now;
+}
+
+bool lwip::NeighbourTable::Refresh(ip4_addr_t const &ip, eth_addr const &mac, uint32_t now)
+{
+	int32_t index = IndexOf(ip4_addr_get_u32(&ip));
+	if (index < 0 || _entries[index]._is_static)
+	{
+		return false;
+	}
+
+	Entry &entry = _entries[index];
+	entry._mac = mac;
+	entry._last_seen_time = now;
+	return true;
+}
+
+bool lwip::NeighbourTable::Remove(ip4_addr_t const &ip)
+{
+	int32_t found = IndexOf(ip4_addr_get_u32(&ip));
+	if (found < 0)
+	{
+		return false;
+	}
+
+	/* 线性探测不能直接把表项清空，否则会截断经过它的探测链。这里把后面的表项往前移，
+	 * 填补空位，只要表项移动后仍然在它的起始位置之后即可。
+	 */
+	uint32_t mask = _capacity - 1;
+	uint32_t hole = static_cast<uint32_t>(found);
+	uint32_t position = hole;
+	for (uint32_t i = 1; i < _capacity; i++)
+	{
+		position = (position + 1) & mask;
+		Entry &entry = _entries[position];
+		if (entry._ip == 0)
+		{
+			break;
+		}
+
+		uint32_t home = HomeIndex(entry._ip);
+
+		// 从起始位置到当前位置的距离，和从起始位置到空位的距离。
+		uint32_t distance_to_position = (position - home) & mask;
+		uint32_t distance_to_hole = (hole - home) & mask;
+		if (distance_to_hole < distance_to_position)
+		{
+			_entries[hole] = entry;
+			hole = position;
+		}
+	}
+
+	_entries[hole] = Entry{};
+	return true;
+}
+
+eth_addr const *lwip::NeighbourTable::Find(ip4_addr_t const &ip, uint32_t now)
+{
+	int32_t index = IndexOf(ip4_addr_get_u32(&ip));
+	if (index < 0 || !IsAlive(_entries[index], now))
+	{
+		_miss_count++;
+		return nullptr;
+	}
+
+	_hit_count++;
+	return &_entries[index]._mac;
+}
+
+lwip::NeighbourTableStatistics lwip::NeighbourTable::Statistics() const
+{
+	lwip::NeighbourTableStatistics statistics{};
+	statistics.hit_count = _hit_count;
+	statistics.miss_count = _miss_count;
+	statistics.eviction_count = _eviction_count;
+	return statistics;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "base/define.h"
+#include "lwip-wrapper/NeighbourTableStatistics.h"
+#include "lwip/etharp.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace lwip
+{
+	/// @brief IPv4 地址到 MAC 地址的邻居表。
+	/// @note lwip 的 ARP 表是一个很小的数组，线性查找，邻居多时会频繁地互相挤出，每次
+	/// 挤出后第一个包都要等一次 ARP 往返。本类是固定容量的开放寻址哈希表，可以开得很大，
+	/// 作为 lwip 的 ARP 表前面的一级缓存。
+	///
+	/// @note 本类不加锁，只能在 lwip 内核上下文中使用。统计数据可以在任意
+	/// 线程中读取。
+	class NeighbourTable
+	{
+	private:
+		DELETE_COPY_AND_MOVE(NeighbourTable)
+
+		class Entry
+		{
+		public:
+			/// @brief IP 地址，网络字节序。为 0 表示空表项。
+			uint32_t _ip = 0;
+
+			eth_addr _mac{};
+
+			/// @brief 静态表项不会老化，也不会被挤出。
+			bool _is_static = false;
+
+			/// @brief 上次刷新的时间，单位：毫秒。
+			uint32_t _last_seen_time = 0;
+		};
+
+		std::unique_ptr<Entry[]> _entries;
+		uint32_t _capacity = 0;
+		uint32_t _aging_time = 0;
+
+		std::atomic_uint64_t _hit_count = 0;
+		std::atomic_uint64_t _miss_count = 0;
+		std::atomic_uint64_t _eviction_count = 0;
+
+		/// @brief 探测的最大长度。所有表项都在离自己的起始位置不超过这个距离的地方。
+		static constexpr uint32_t _max_probe_count = 16;
+
+		uint32_t HomeIndex(uint32_t ip) const;
+
+		bool IsAlive(Entry const &entry, uint32_t now) const;
+
+		/// @brief 查找表项的位置。
+		/// @param ip
+		/// @return 找不到返回 -1.
+		int32_t IndexOf(uint32_t ip) const;
+
+	public:
+		/// @brief 构造函数。
+		/// @param capacity 表项个数。会向上取整到 2 的整数次幂。
+		/// @param aging_time 动态表项的老化时间，单位：毫秒。
+		NeighbourTable(uint32_t capacity, uint32_t aging_time);
+
+		/// @brief 学习或刷新一个邻居。
+		/// @note 已经是静态表项的邻居不会被动态学习覆盖。
+		/// @param ip
+		/// @param mac
+		/// @param now 当前时间，单位：毫秒。
+		/// @param is_static 是否是静态表项。
+		void Learn(ip4_addr_t const &ip, eth_addr const &mac, uint32_t now, bool is_static);
+
+		/// @brief 只刷新已经存在的动态表项，不插入新的表项。
+		/// @note 对应 lwip 对不是发给本机的 ARP 报文的处理，防止子网中任意主机的 ARP 报文
+		/// 把表项挤出去或者伪造表项。
+		/// @param ip
+		/// @param mac
+		/// @param now 当前时间，单位：毫秒。
+		/// @return 表项存在并被刷新返回 true.
+		bool Refresh(ip4_addr_t const &ip, eth_addr const &mac, uint32_t now);
+
+		/// @brief 移除一个邻居。
+		/// @param ip
+		/// @return 移除成功返回 true, 不存在返回 false.
+		bool Remove(ip4_addr_t const &ip);
+
+		/// @brief 查找邻居的 MAC 地址，并统计命中和未命中的次数。
+		/// @param ip
+		/// @param now 当前时间，单位：毫秒。
+		/// @return 找不到或已老化返回空指针。
+		eth_addr const *Find(ip4_addr_t const &ip, uint32_t now);
+
+		/// @brief 获取统计数据。
+		/// @return
+		lwip::NeighbourTableStatistics Statistics() const;
+	};
+} // namespace lwip
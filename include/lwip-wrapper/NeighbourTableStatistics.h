@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+namespace lwip
+{
+	/// @brief 邻居表的统计数据。
+	class NeighbourTableStatistics
+	{
+	public:
+		/// @brief 发送时在邻居表中找到下一跳 MAC 地址的次数。
+		uint64_t hit_count = 0;
+
+		/// @brief 发送时在邻居表中找不到下一跳 MAC 地址，交给 lwip 的 ARP 处理的次数。
+		uint64_t miss_count = 0;
+
+		/// @brief 因为探测窗口已满而被挤出的表项个数。
+		uint64_t eviction_count = 0;
+	};
+} // namespace lwip
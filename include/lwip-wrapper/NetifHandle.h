@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+namespace lwip
+{
+	/// @brief 插槽中网卡的句柄。
+	/// @note 通过句柄查找网卡只是一次数组下标访问，不需要对网卡名称做哈希。网卡被移除后
+	/// 句柄失效，即使位置被新插入的网卡复用，旧句柄也不会找到新网卡。
+	class NetifHandle
+	{
+	public:
+		/// @brief 网卡在快照中的位置。
+		uint32_t _index = 0;
+
+		/// @brief 网卡插入插槽时分配的编号。为 0 表示无效的句柄。
+		uint32_t _id = 0;
+
+		/// @brief 检查句柄是否有效。
+		/// @note 有效的句柄对应的网卡也可能已经被移除了。
+		/// @return
+		bool IsValid() const
+		{
+			return _id != 0;
+		}
+	};
+} // namespace lwip
@@ -1,8 +1,32 @@
 #include "NetifSlot.h"
 #include "base/SingletonProvider.h"
+#include "lwip-wrapper/lwip_convert.h"
+#include "lwip-wrapper/TcpIpCall.h"
 #include <base/string/define.h>
 #include <bsp-interface/di/interrupt.h>
 
+namespace
+{
+	/// @brief 在作用域内持有写者锁。
+	class WriterLockGuard
+	{
+	private:
+		base::task::BinarySemaphore &_lock;
+
+	public:
+		WriterLockGuard(base::task::BinarySemaphore &lock)
+			: _lock(lock)
+		{
+			_lock.Acquire();
+		}
+
+		~WriterLockGuard()
+		{
+			_lock.Release();
+		}
+	};
+} // namespace
+
 void lwip::NetifSlot::PlugIn(std::shared_ptr<lwip::NetifWrapper> const &o)
 {
 	if (o == nullptr)
@@ -10,6 +34,8 @@ void lwip::NetifSlot::PlugIn(std::shared_ptr<lwip::NetifWrapper> const &o)
 		throw std::invalid_argument{std::string{CODE_POS_STR} + "禁止传入空指针。"};
 	}
 
+	WriterLockGuard writer_lock_guard{_writer_lock};
+
 	try
 	{
 		_netif_dic.Add(o->Name(), o);
@@ -18,32 +44,281 @@ void lwip::NetifSlot::PlugIn(std::shared_ptr<lwip::NetifWrapper> const &o)
 	{
 		throw std::runtime_error{std::string{CODE_POS_STR} + e.what()};
 	}
+
+	if (_bridge_enabled)
+	{
+		try
+		{
+			_bridge.AddPort(o.get());
+		}
+		catch (std::exception const &e)
+		{
+			_netif_dic.Remove(o->Name());
+			throw std::runtime_error{std::string{CODE_POS_STR} + e.what()};
+		}
+
+		// 先限制校验和卸载，再开始转发。
+		LimitBridgeChecksumOffload();
+		o->SetBridge(&_bridge);
+	}
+
+	// 复制旧快照，放进第一个空位。
+	std::shared_ptr<lwip::NetifSlotSnapshot> snapshot{new lwip::NetifSlotSnapshot{*_snapshot.Load()}};
+	lwip::NetifSlotSnapshot::Entry entry{};
+	entry._id = _next_id++;
+	if (_next_id == 0)
+	{
+		// 编号 0 表示空位，回绕时跳过。
+		_next_id = 1;
+	}
+
+	entry._name = o->Name();
+	entry._netif = o;
+
+	bool placed = false;
+	for (lwip::NetifSlotSnapshot::Entry &slot : snapshot->_entries)
+	{
+		if (slot._id == 0)
+		{
+			slot = entry;
+			placed = true;
+			break;
+		}
+	}
+
+	if (!placed)
+	{
+		snapshot->_entries.push_back(entry);
+	}
+
+	snapshot->_count++;
+	_snapshot.Store(snapshot);
 }
 
-std::shared_ptr<lwip::NetifWrapper> lwip::NetifSlot::Find(std::string const &key)
+bool lwip::NetifSlot::Remove(std::string const &name)
 {
-	std::shared_ptr<lwip::NetifWrapper> *pp = _netif_dic.Find(key);
+	WriterLockGuard writer_lock_guard{_writer_lock};
+
+	std::shared_ptr<lwip::NetifWrapper> *pp = _netif_dic.Find(name);
 	if (pp == nullptr)
 	{
-		return nullptr;
+		return false;
 	}
 
-	return *pp;
+	std::shared_ptr<lwip::NetifWrapper> netif_wrapper = *pp;
+
+	// 先让读者看不到这张网卡。
+	std::shared_ptr<lwip::NetifSlotSnapshot> snapshot{new lwip::NetifSlotSnapshot{*_snapshot.Load()}};
+	int32_t index = snapshot->IndexOf(name);
+	if (index >= 0)
+	{
+		snapshot->_entries[index] = lwip::NetifSlotSnapshot::Entry{};
+		snapshot->_count--;
+	}
+
+	_snapshot.Store(snapshot);
+
+	// RemovePort 返回后，其他网卡的接收线程不会再经网桥访问这张网卡，可以释放最后一个引用。
+	netif_wrapper->SetBridge(nullptr);
+	_bridge.RemovePort(netif_wrapper.get());
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			_route_table.RemoveAll(netif_wrapper->WrappedObj());
+		});
+
+	bool removed = _netif_dic.Remove(name);
+	if (_bridge_enabled)
+	{
+		// 剩下的网卡可能可以卸载更多的项目。
+		netif_wrapper->UnlimitChecksumOffload();
+		LimitBridgeChecksumOffload();
+	}
+
+	return removed;
+}
+
+std::shared_ptr<lwip::NetifWrapper> lwip::NetifSlot::Find(std::string const &name) const
+{
+	return _snapshot.Load()->Find(name);
+}
+
+std::shared_ptr<lwip::NetifWrapper> lwip::NetifSlot::Find(lwip::NetifHandle const &handle) const
+{
+	return _snapshot.Load()->Find(handle);
+}
+
+lwip::NetifHandle lwip::NetifSlot::GetHandle(std::string const &name) const
+{
+	std::shared_ptr<lwip::NetifSlotSnapshot const> snapshot = _snapshot.Load();
+	int32_t index = snapshot->IndexOf(name);
+	if (index < 0)
+	{
+		return lwip::NetifHandle{};
+	}
+
+	lwip::NetifHandle handle{};
+	handle._index = static_cast<uint32_t>(index);
+	handle._id = snapshot->_entries[index]._id;
+	return handle;
 }
 
 std::shared_ptr<lwip::NetifWrapper> lwip::NetifSlot::FindDefaultNetif() const
 {
-	for (std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>> const &pair : _netif_dic)
+	std::shared_ptr<lwip::NetifSlotSnapshot const> snapshot = _snapshot.Load();
+	for (lwip::NetifSlotSnapshot::Entry const &entry : snapshot->_entries)
 	{
-		if (pair.second->IsDefaultNetInterface())
+		if (entry._netif != nullptr && entry._netif->IsDefaultNetInterface())
 		{
-			return pair.second;
+			return entry._netif;
 		}
 	}
 
 	return nullptr;
 }
 
+#pragma region 路由
+
+void lwip::NetifSlot::AddRoute(base::IPAddress const &network,
+							   base::IPAddress const &netmask,
+							   base::IPAddress const &gateway,
+							   std::string const &netif_name)
+{
+	WriterLockGuard writer_lock_guard{_writer_lock};
+	std::shared_ptr<lwip::NetifWrapper> netif_wrapper = Find(netif_name);
+	if (netif_wrapper == nullptr)
+	{
+		throw std::invalid_argument{std::string{CODE_POS_STR} + "插槽中没有名为 " + netif_name + " 的网卡。"};
+	}
+
+	ip_addr_t ip_addr_t_network{};
+	ip_addr_t_network << network;
+
+	ip_addr_t ip_addr_t_netmask{};
+	ip_addr_t_netmask << netmask;
+
+	ip_addr_t ip_addr_t_gateway{};
+	ip_addr_t_gateway << gateway;
+
+	int32_t prefix_length = lwip::RouteTable::PrefixLength(ip_addr_t_netmask);
+	if (prefix_length < 0)
+	{
+		throw std::invalid_argument{std::string{CODE_POS_STR} + "子网掩码必须是连续的。"};
+	}
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			_route_table.Add(ip_addr_t_network, prefix_length, ip_addr_t_gateway, netif_wrapper->WrappedObj());
+		});
+}
+
+bool lwip::NetifSlot::RemoveRoute(base::IPAddress const &network, base::IPAddress const &netmask)
+{
+	ip_addr_t ip_addr_t_network{};
+	ip_addr_t_network << network;
+
+	ip_addr_t ip_addr_t_netmask{};
+	ip_addr_t_netmask << netmask;
+
+	int32_t prefix_length = lwip::RouteTable::PrefixLength(ip_addr_t_netmask);
+	if (prefix_length < 0)
+	{
+		return false;
+	}
+
+	bool removed = false;
+	lwip::TcpIpCall(
+		[&]()
+		{
+			removed = _route_table.Remove(ip_addr_t_network, prefix_length);
+		});
+
+	return removed;
+}
+
+#pragma endregion
+
+#pragma region 网桥
+
+void lwip::NetifSlot::LimitBridgeChecksumOffload()
+{
+	lwip::ChecksumOffloadCapability capability{};
+	bool first = true;
+	for (std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>> const &pair : _netif_dic)
+	{
+		if (first)
+		{
+			capability = pair.second->ChecksumOffloadCapability();
+			first = false;
+		}
+		else
+		{
+			capability = capability.Intersect(pair.second->ChecksumOffloadCapability());
+		}
+	}
+
+	for (std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>> const &pair : _netif_dic)
+	{
+		pair.second->LimitChecksumOffload(capability);
+	}
+}
+
+void lwip::NetifSlot::EnableBridge()
+{
+	WriterLockGuard writer_lock_guard{_writer_lock};
+	if (_bridge_enabled)
+	{
+		return;
+	}
+
+	try
+	{
+		for (std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>> const &pair : _netif_dic)
+		{
+			_bridge.AddPort(pair.second.get());
+		}
+	}
+	catch (std::exception const &e)
+	{
+		for (std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>> const &pair : _netif_dic)
+		{
+			_bridge.RemovePort(pair.second.get());
+		}
+
+		throw std::runtime_error{std::string{CODE_POS_STR} + e.what()};
+	}
+
+	// 先限制校验和卸载，再开始转发。
+	LimitBridgeChecksumOffload();
+	for (std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>> const &pair : _netif_dic)
+	{
+		pair.second->SetBridge(&_bridge);
+	}
+
+	_bridge_enabled = true;
+}
+
+void lwip::NetifSlot::DisableBridge()
+{
+	WriterLockGuard writer_lock_guard{_writer_lock};
+	if (!_bridge_enabled)
+	{
+		return;
+	}
+
+	_bridge_enabled = false;
+	for (std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>> const &pair : _netif_dic)
+	{
+		pair.second->SetBridge(nullptr);
+		_bridge.RemovePort(pair.second.get());
+		pair.second->UnlimitChecksumOffload();
+	}
+}
+
+#pragma endregion
+
 namespace
 {
 	base::SingletonProvider<lwip::NetifSlot> _provider{};
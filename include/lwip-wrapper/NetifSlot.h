@@ -1,7 +1,14 @@
 #pragma once
 #include <base/container/Dictionary.h>
 #include <base/define.h>
+#include <base/task/BinarySemaphore.h>
+#include <lwip-wrapper/Bridge.h>
+#include <lwip-wrapper/NetifHandle.h>
+#include <lwip-wrapper/NetifSlotEnumerator.h>
+#include <lwip-wrapper/NetifSlotSnapshot.h>
 #include <lwip-wrapper/NetifWrapper.h>
+#include <lwip-wrapper/RouteTable.h>
+#include <lwip-wrapper/SnapshotPointer.h>
 #include <string>
 
 namespace lwip
@@ -9,13 +16,33 @@ namespace lwip
 	/// @brief 网卡插槽。
 	/// @note NetifWrapper 打开后就会向 lwip 注册，网卡就可以使用了。但是必须始终保持 NetifWrapper 对象
 	/// 不析构，否则网卡会销毁。如果没法自己保存 NetifWrapper 对象，就把它放到本插槽中。
+	///
+	/// @note 查找类的方法读取的是不可变的快照，不加锁，可以在任意线程中与 PlugIn, Remove
+	/// 同时调用。PlugIn, Remove 等修改类的方法之间互斥。
 	class NetifSlot
 	{
 	private:
 		DELETE_COPY_AND_MOVE(NetifSlot)
 
+		/// @brief 修改类的方法之间的互斥锁。
+		base::task::BinarySemaphore _writer_lock{true};
+
+		/// @brief 写者使用的字典。只在持有 _writer_lock 时修改。
 		base::Dictionary<std::string, std::shared_ptr<lwip::NetifWrapper>> _netif_dic;
 
+		/// @brief 读者使用的快照。
+		lwip::SnapshotPointer<lwip::NetifSlotSnapshot> _snapshot{};
+
+		/// @brief 下一张插入的网卡的编号。
+		uint32_t _next_id = 1;
+
+		lwip::Bridge _bridge{};
+		std::atomic_bool _bridge_enabled = false;
+		lwip::RouteTable _route_table{};
+
+		/// @brief 让网桥中的每张网卡只卸载所有网卡都支持的校验和项目。需要持有 _writer_lock.
+		void LimitBridgeChecksumOffload();
+
 	public:
 		NetifSlot() = default;
 
@@ -26,34 +53,101 @@ namespace lwip
 		/// @brief 移除一张网卡。
 		/// @param name 网卡名称。
 		/// @return 移除成功返回 true，元素不存在返回 false。
-		bool Remove(std::string const &name)
-		{
-			return _netif_dic.Remove(name);
-		}
+		bool Remove(std::string const &name);
 
 		/// @brief 查找一张网卡。找不到会返回空指针。
 		/// @param name 网卡名称。
 		/// @return
-		std::shared_ptr<lwip::NetifWrapper> Find(std::string const &name);
+		std::shared_ptr<lwip::NetifWrapper> Find(std::string const &name) const;
+
+		/// @brief 通过句柄查找一张网卡。找不到会返回空指针。
+		/// @note 不需要对名称做比较或哈希，适合每个包或每个请求都要查找网卡的场合。
+		/// @param handle 通过 GetHandle 获取的句柄。
+		/// @return
+		std::shared_ptr<lwip::NetifWrapper> Find(lwip::NetifHandle const &handle) const;
+
+		/// @brief 获取网卡的句柄。
+		/// @param name 网卡名称。
+		/// @return 网卡不存在则返回无效的句柄。
+		lwip::NetifHandle GetHandle(std::string const &name) const;
 
 		/// @brief 获取网卡个数。
 		/// @return
 		int Count() const
 		{
-			return _netif_dic.Count();
+			return _snapshot.Load()->Count();
+		}
+
+		/// @brief 获取当前的快照。
+		/// @note 快照不会随之后的 PlugIn, Remove 变化。需要遍历网卡时应该使用快照。
+		/// @return
+		std::shared_ptr<lwip::NetifSlotSnapshot const> Snapshot() const
+		{
+			return _snapshot.Load();
 		}
 
 		/// @brief 获取迭代器
+		/// @note 迭代器持有当前的快照，可以与 PlugIn, Remove 同时使用。
 		/// @return
-		std::shared_ptr<base::IEnumerator<std::pair<std::string const, std::shared_ptr<lwip::NetifWrapper>>>> GetEnumerator()
+		lwip::NetifSlotEnumerator GetEnumerator() const
 		{
-			return _netif_dic.GetEnumerator();
+			return lwip::NetifSlotEnumerator{_snapshot.Load()};
 		}
 
 		/// @brief 在已插入插槽的网卡中查找作为 lwip 默认网卡的网卡。有可能找不到。
 		/// 找不到有可能是 lwip 没有默认网卡，也可能是默认网卡没有插入插槽中。
 		/// @return 找不到会返回空指针。
 		std::shared_ptr<lwip::NetifWrapper> FindDefaultNetif() const;
+
+#pragma region 路由
+		/// @brief 添加一条静态路由。相同目的网络的路由已存在则替换。
+		/// @note 需要在 lwipopts.h 中将 LWIP_HOOK_FILENAME 定义为 "lwip-wrapper/lwip_hooks.h",
+		/// lwip 才会使用本路由表。lwip 总是先匹配网卡所在的子网，匹配不到时才查找本路由表，
+		/// 本路由表也匹配不到时使用默认网卡。
+		/// @param network 目的网络。
+		/// @param netmask 目的网络的子网掩码。必须是连续的。
+		/// @param gateway 下一跳网关。为 0.0.0.0 表示目的网络直接连在出口网卡上。
+		/// @param netif_name 出口网卡的名称。网卡必须已经插入本插槽。
+		void AddRoute(base::IPAddress const &network,
+					  base::IPAddress const &netmask,
+					  base::IPAddress const &gateway,
+					  std::string const &netif_name);
+
+		/// @brief 移除一条静态路由。
+		/// @param network 目的网络。
+		/// @param netmask 目的网络的子网掩码。
+		/// @return 移除成功返回 true, 路由不存在返回 false.
+		bool RemoveRoute(base::IPAddress const &network, base::IPAddress const &netmask);
+
+		/// @brief 获取路由表。
+		/// @note 供 lwip 的钩子函数在 tcpip 线程中使用。
+		/// @return
+		lwip::RouteTable const &Routes() const
+		{
+			return _route_table;
+		}
+#pragma endregion
+
+#pragma region 网桥
+		/// @brief 开启网桥模式。
+		/// @note 开启后插槽中的所有网卡，包括之后插入的网卡，都成为网桥的端口。网卡之间的
+		/// 二层转发在接收线程中直接完成，不经过 lwip. 只有发给本机 MAC 地址的帧和广播帧、
+		/// 组播帧会输入 lwip.
+		///
+		/// @note 网卡的校验和卸载能力不同时，所有网卡都只卸载共同支持的项目，其余的由 lwip
+		/// 用软件计算。网卡应该先打开再插入，没有打开的网卡不支持任何卸载。
+		void EnableBridge();
+
+		/// @brief 关闭网桥模式。
+		void DisableBridge();
+
+		/// @brief 检查网桥模式是否开启。
+		/// @return
+		bool BridgeEnabled() const
+		{
+			return _bridge_enabled;
+		}
+#pragma endregion
 	};
 
 	lwip::NetifSlot &net_if_slot();
@@ -0,0 +1,49 @@
+#pragma once
+#include "lwip-wrapper/NetifSlotSnapshot.h"
+#include <memory>
+
+namespace lwip
+{
+	/// @brief 遍历网卡插槽的迭代器。
+	/// @note 持有创建时的快照并遍历它，迭代期间可以在其他线程中 PlugIn, Remove, 遍历到的
+	/// 始终是创建时插槽中的网卡。
+	class NetifSlotEnumerator
+	{
+	private:
+		std::shared_ptr<lwip::NetifSlotSnapshot const> _snapshot;
+
+		/// @brief 当前表项在快照中的位置。为 -1 表示还没有调用过 MoveNext.
+		int32_t _index = -1;
+
+	public:
+		NetifSlotEnumerator(std::shared_ptr<lwip::NetifSlotSnapshot const> const &snapshot)
+			: _snapshot(snapshot)
+		{
+		}
+
+		/// @brief 移动到下一张网卡。跳过被移除的网卡留下的空位。
+		/// @return 移动到了一张网卡返回 true, 已经遍历完返回 false.
+		bool MoveNext()
+		{
+			int32_t size = static_cast<int32_t>(_snapshot->_entries.size());
+			while (_index < size)
+			{
+				_index++;
+				if (_index < size && _snapshot->_entries[_index]._id != 0)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		/// @brief 当前的网卡。
+		/// @warning 必须在 MoveNext 返回 true 后才能调用。
+		/// @return
+		lwip::NetifSlotSnapshot::Entry const &Current() const
+		{
+			return _snapshot->_entries[_index];
+		}
+	};
+} // namespace lwip
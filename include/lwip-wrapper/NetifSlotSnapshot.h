@@ -0,0 +1,89 @@
+#pragma once
+#include "lwip-wrapper/NetifHandle.h"
+#include "lwip-wrapper/NetifWrapper.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lwip
+{
+	/// @brief 网卡插槽在某一时刻的不可变快照。
+	/// @note 插入或移除网卡时构造新的快照并整体替换，快照本身从不修改，所以可以被多个
+	/// 线程无锁地读取。
+	class NetifSlotSnapshot
+	{
+	public:
+		class Entry
+		{
+		public:
+			/// @brief 插入插槽时分配的编号。为 0 表示该位置空闲。
+			uint32_t _id = 0;
+
+			std::string _name;
+			std::shared_ptr<lwip::NetifWrapper> _netif;
+		};
+
+		/// @brief 下标就是句柄中的位置。被移除的网卡留下空位，供之后插入的网卡复用。
+		std::vector<Entry> _entries;
+
+		/// @brief 网卡个数。
+		int _count = 0;
+
+		/// @brief 查找网卡的位置。
+		/// @note 网卡一般只有几张，直接遍历比哈希更快。
+		/// @param name
+		/// @return 找不到返回 -1.
+		int32_t IndexOf(std::string const &name) const
+		{
+			for (uint32_t i = 0; i < _entries.size(); i++)
+			{
+				if (_entries[i]._id != 0 && _entries[i]._name == name)
+				{
+					return static_cast<int32_t>(i);
+				}
+			}
+
+			return -1;
+		}
+
+		/// @brief 查找一张网卡。
+		/// @param name
+		/// @return 找不到返回空指针。
+		std::shared_ptr<lwip::NetifWrapper> Find(std::string const &name) const
+		{
+			int32_t index = IndexOf(name);
+			if (index < 0)
+			{
+				return nullptr;
+			}
+
+			return _entries[index]._netif;
+		}
+
+		/// @brief 通过句柄查找一张网卡。
+		/// @param handle
+		/// @return 找不到返回空指针。
+		std::shared_ptr<lwip::NetifWrapper> Find(lwip::NetifHandle const &handle) const
+		{
+			if (!handle.IsValid() || handle._index >= _entries.size())
+			{
+				return nullptr;
+			}
+
+			Entry const &entry = _entries[handle._index];
+			if (entry._id != handle._id)
+			{
+				return nullptr;
+			}
+
+			return entry._netif;
+		}
+
+		/// @brief 获取网卡个数。
+		/// @return
+		int Count() const
+		{
+			return _count;
+		}
+	};
+} // namespace lwip
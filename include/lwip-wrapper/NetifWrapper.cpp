@@ -3,11 +3,22 @@
 #include "base/string/define.h"
 #include "base/task/delay.h"
 #include "base/task/task.h"
+#include "FlowHash.h"
+#include "lwip-wrapper/Bridge.h"
+#include "lwip-wrapper/IChecksumOffload.h"
+#include "lwip-wrapper/IFrameTimestamping.h"
 #include "lwip-wrapper/lwip_convert.h"
+#include "lwip-wrapper/NeighbourTable.h"
+#include "lwip-wrapper/NetifSlot.h"
+#include "lwip-wrapper/TcpIpCall.h"
 #include "lwip/dhcp.h"
 #include "lwip/etharp.h"
+#include "lwip/sys.h"
 #include "lwip/tcpip.h"
+#include "netif/ethernet.h"
+#include "InputPbuf.h"
 #include "TcpIpInitialize.h"
+#include <cstring>
 #include <vector>
 
 class lwip::NetifWrapper::LinkController
@@ -101,6 +112,130 @@ public:
 	int32_t _mtu = 1500;
 };
 
+class lwip::NetifWrapper::Member
+{
+public:
+	Member(base::ethernet::IEthernetPort *ethernet_port)
+		: _ethernet_port(ethernet_port),
+		  _timestamping(dynamic_cast<lwip::IFrameTimestamping *>(ethernet_port))
+	{
+	}
+
+	base::ethernet::IEthernetPort *_ethernet_port = nullptr;
+
+	/// @brief 端口的硬件时间戳接口。不支持时为空指针。
+	lwip::IFrameTimestamping *_timestamping = nullptr;
+
+	/// @brief 获取刚收到的帧的时间戳。没有硬件时间戳时使用软件时钟。
+	/// @return
+	lwip::FrameTimestamp ReceivingTimestamp()
+	{
+		lwip::FrameTimestamp timestamp{};
+		if (_timestamping != nullptr && _timestamping->TryGetReceivingTimestamp(timestamp._time))
+		{
+			timestamp._source = lwip::FrameTimestampSource::Hardware;
+			return timestamp;
+		}
+
+		return lwip::FrameTimestamp::Now();
+	}
+
+	/// @brief 获取刚发送的帧的时间戳。没有硬件时间戳时使用软件时钟。
+	/// @return
+	lwip::FrameTimestamp SendingTimestamp()
+	{
+		lwip::FrameTimestamp timestamp{};
+		if (_timestamping != nullptr && _timestamping->TryGetSendingTimestamp(timestamp._time))
+		{
+			timestamp._source = lwip::FrameTimestampSource::Hardware;
+			return timestamp;
+		}
+
+		return lwip::FrameTimestamp::Now();
+	}
+	std::shared_ptr<base::IIdToken> _receiving_event_unsubscribe_token;
+	std::shared_ptr<base::IIdToken> _connection_event_unsubscribe_token;
+	std::shared_ptr<base::IIdToken> _disconnection_event_unsubscribe_token;
+
+	static constexpr std::size_t CacheLineSize = 64;
+
+	/// @brief 正在使用本成员的收发路径的个数。独占一个缓存行。
+	alignas(CacheLineSize) std::atomic_int32_t _in_flight_count = 0;
+
+	alignas(CacheLineSize) std::atomic_bool _link_up = false;
+	std::atomic_uint64_t _sent_frame_count = 0;
+	std::atomic_uint64_t _sent_byte_count = 0;
+	std::atomic_uint64_t _sending_error_count = 0;
+	std::atomic_uint64_t _received_frame_count = 0;
+	std::atomic_uint64_t _received_byte_count = 0;
+	std::atomic_uint64_t _link_down_count = 0;
+};
+
+/// @brief 在作用域内登记为正在执行的收发路径。
+/// @note 先登记再检查 _disposed, 与 Dispose 先设置 _disposed 再检查计数的顺序相对，两者都是
+/// 顺序一致的原子操作，所以要么本守卫看到 _disposed, 要么 Dispose 等到本守卫离开。
+class lwip::NetifWrapper::FastPathGuard
+{
+private:
+	std::atomic_int32_t &_in_flight_count;
+	bool _entered = false;
+
+public:
+	/// @brief 登记在网卡的计数上。用于不属于某个成员端口的路径。
+	/// @param netif_wrapper
+	FastPathGuard(NetifWrapper &netif_wrapper)
+		: _in_flight_count(netif_wrapper._in_flight_count)
+	{
+		_in_flight_count.fetch_add(1);
+		_entered = !netif_wrapper._disposed.load();
+	}
+
+	/// @brief 登记在成员端口的计数上。
+	/// @param netif_wrapper
+	/// @param member
+	FastPathGuard(NetifWrapper &netif_wrapper, Member &member)
+		: _in_flight_count(member._in_flight_count)
+	{
+		_in_flight_count.fetch_add(1);
+		_entered = !netif_wrapper._disposed.load();
+	}
+
+	~FastPathGuard()
+	{
+		_in_flight_count.fetch_sub(1);
+	}
+
+	DELETE_COPY_AND_MOVE(FastPathGuard)
+
+	/// @brief 是否可以继续。网卡正在释放资源时为 false.
+	/// @return
+	bool Entered() const
+	{
+		return _entered;
+	}
+};
+
+/// @brief 在作用域内持有本网卡的发送锁。
+class lwip::NetifWrapper::SendingLockGuard
+{
+private:
+	NetifWrapper &_netif_wrapper;
+
+public:
+	SendingLockGuard(NetifWrapper &netif_wrapper)
+		: _netif_wrapper(netif_wrapper)
+	{
+		_netif_wrapper._sending_lock.Acquire();
+	}
+
+	~SendingLockGuard()
+	{
+		_netif_wrapper._sending_lock.Release();
+	}
+
+	DELETE_COPY_AND_MOVE(SendingLockGuard)
+};
+
 void lwip::NetifWrapper::InitializationCallbackFunc()
 {
 	_wrapped_obj->hostname = _name.c_str();
@@ -118,18 +253,31 @@ void lwip::NetifWrapper::InitializationCallbackFunc()
 	 */
 	_wrapped_obj->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP;
 
+	ApplyChecksumOffload();
+
 	/* We directly use etharp_output() here to save a function call.
 	 * You can instead declare your own function an call etharp_output()
 	 * from it if you have to do some checks before sending (e.g. if link
 	 * is available...)
 	 */
 	_wrapped_obj->output = etharp_output;
+	if (_neighbour_table != nullptr)
+	{
+		_wrapped_obj->output = NeighbourTableOutputFunc;
+	}
 
 	_wrapped_obj->linkoutput = [](netif *net_interface, pbuf *p) -> err_t
 	{
+		NetifWrapper *self = reinterpret_cast<NetifWrapper *>(net_interface->state);
+		FastPathGuard g{*self};
+		if (!g.Entered())
+		{
+			return err_enum_t::ERR_IF;
+		}
+
 		try
 		{
-			reinterpret_cast<NetifWrapper *>(net_interface->state)->SendPbuf(p);
+			self->SendPbuf(p);
 			return err_enum_t::ERR_OK;
 		}
 		catch (std::exception const &e)
@@ -139,9 +287,69 @@ void lwip::NetifWrapper::InitializationCallbackFunc()
 	};
 }
 
+void lwip::NetifWrapper::NegotiateChecksumOffload()
+{
+	lwip::ChecksumOffloadCapability capability{};
+	bool first = true;
+	for (std::shared_ptr<Member> const &member : _members)
+	{
+		lwip::IChecksumOffload *offload = dynamic_cast<lwip::IChecksumOffload *>(member->_ethernet_port);
+		if (offload == nullptr)
+		{
+			// 有一个成员不支持，就全部由软件计算。
+			_checksum_offload_capability = lwip::ChecksumOffloadCapability{};
+			return;
+		}
+
+		if (first)
+		{
+			capability = offload->ChecksumOffloadCapability();
+			first = false;
+		}
+		else
+		{
+			capability = capability.Intersect(offload->ChecksumOffloadCapability());
+		}
+	}
+
+	_checksum_offload_capability = capability;
+}
+
+void lwip::NetifWrapper::ApplyChecksumOffload()
+{
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+	// 标志位为 1 表示由 lwip 用软件计算。
+	u16_t flags = NETIF_CHECKSUM_ENABLE_ALL;
+	lwip::ChecksumOffloadCapability capability = _checksum_offload_capability;
+	if (_checksum_offload_limited)
+	{
+		capability = capability.Intersect(_checksum_offload_limit);
+	}
+
+	auto clear_if = [&flags](bool offloaded, u16_t flag)
+	{
+		if (offloaded)
+		{
+			flags &= static_cast<u16_t>(~flag);
+		}
+	};
+
+	clear_if(capability.ip_generation, NETIF_CHECKSUM_GEN_IP);
+	clear_if(capability.ip_checking, NETIF_CHECKSUM_CHECK_IP);
+	clear_if(capability.udp_generation, NETIF_CHECKSUM_GEN_UDP);
+	clear_if(capability.udp_checking, NETIF_CHECKSUM_CHECK_UDP);
+	clear_if(capability.tcp_generation, NETIF_CHECKSUM_GEN_TCP);
+	clear_if(capability.tcp_checking, NETIF_CHECKSUM_CHECK_TCP);
+	clear_if(capability.icmp_generation, NETIF_CHECKSUM_GEN_ICMP);
+	clear_if(capability.icmp_checking, NETIF_CHECKSUM_CHECK_ICMP);
+
+	NETIF_SET_CHECKSUM_CTRL(_wrapped_obj.get(), flags);
+#endif
+}
+
 void lwip::NetifWrapper::SendPbuf(pbuf *p)
 {
-	if (_ethernet_port == nullptr)
+	if (_members.empty())
 	{
 		throw std::runtime_error{"必须先调用 Open 方法传入一个 bsp::IEthernetPort 对象"};
 	}
@@ -158,7 +366,74 @@ void lwip::NetifWrapper::SendPbuf(pbuf *p)
 		_sending_spans.push_back(span);
 	}
 
-	_ethernet_port->Send(_sending_spans);
+	/* 在网桥中时，本机协议栈发出的帧也要按 MAC 地址学习表选择出口，广播帧和未知单播帧
+	 * 要泛洪到所有端口，否则到不了其他端口后面的主机。
+	 */
+	lwip::Bridge *bridge = _bridge.load(std::memory_order_acquire);
+	if (bridge != nullptr && bridge->Output(this, _sending_spans, p->tot_len))
+	{
+		return;
+	}
+
+	Member &member = SelectSendingMember(_sending_spans[0]);
+	SendingLockGuard g{*this};
+	SendSpans(member, _sending_spans, p->tot_len);
+}
+
+void lwip::NetifWrapper::SendSpans(Member &member, std::vector<base::ReadOnlySpan> const &spans, int32_t size)
+{
+	try
+	{
+		member._ethernet_port->Send(spans);
+	}
+	catch (std::exception const &e)
+	{
+		member._sending_error_count++;
+		throw;
+	}
+
+	member._sent_frame_count++;
+	member._sent_byte_count += size;
+
+	if (_sending_timestamp_callback != nullptr)
+	{
+		_sending_timestamp_callback(member.SendingTimestamp(), spans[0]);
+	}
+}
+
+lwip::NetifWrapper::Member &lwip::NetifWrapper::SelectSendingMember(base::ReadOnlySpan const &first_segment)
+{
+	if (_members.size() == 1)
+	{
+		return *_members[0];
+	}
+
+	/* 没有任何成员链路接通时，在全部成员中选择，保持与单端口网卡相同的行为。
+	 * 只读取一次 _up_member_count, 否则两次读取之间其他线程可能把它减到 0.
+	 */
+	int up_member_count = _up_member_count.load();
+	bool only_up_members = up_member_count > 0;
+	uint32_t candidate_count = only_up_members ? static_cast<uint32_t>(up_member_count) : _members.size();
+	uint32_t index = lwip::FlowHash(first_segment, _hash_policy) % candidate_count;
+	for (std::shared_ptr<Member> const &member : _members)
+	{
+		if (only_up_members && !member->_link_up)
+		{
+			continue;
+		}
+
+		if (index == 0)
+		{
+			return *member;
+		}
+
+		index--;
+	}
+
+	/* _up_member_count 与各成员的 _link_up 不是同时更新的，读取到的个数可能比实际
+	 * 接通的成员多，这时候退回到第一个成员。
+	 */
+	return *_members[0];
 }
 
 void lwip::NetifWrapper::LinkStateDetectingThreadFunc()
@@ -198,24 +473,76 @@ void lwip::NetifWrapper::LinkStateDetectingThreadFunc()
 	}
 }
 
-void lwip::NetifWrapper::OnInput(base::ReadOnlySpan span)
+void lwip::NetifWrapper::OnInput(Member &member, base::ReadOnlySpan span)
 {
-	pbuf_custom *custom_pbuf = new pbuf_custom{};
-	custom_pbuf->custom_free_function = [](pbuf *p)
+	FastPathGuard g{*this, member};
+	if (!g.Entered())
 	{
-		delete reinterpret_cast<pbuf_custom *>(p);
-	};
+		return;
+	}
+
+	member._received_frame_count++;
+	member._received_byte_count += span.Size();
+
+	// 尽早取时间戳，不把网桥的处理时间算进去。
+	lwip::FrameTimestamp timestamp{};
+	bool timestamping_enabled = _timestamping_enabled.load(std::memory_order_relaxed);
+	if (timestamping_enabled)
+	{
+		timestamp = member.ReceivingTimestamp();
+	}
+
+	lwip::Bridge *bridge = _bridge.load(std::memory_order_acquire);
+	if (bridge != nullptr && !bridge->Input(this, span))
+	{
+		// 已被网桥转发，不是发给本机的。
+		return;
+	}
+
+	InputFrame(span, timestamping_enabled ? &timestamp : nullptr);
+}
+
+void lwip::NetifWrapper::InputFrame(base::ReadOnlySpan const &frame)
+{
+	FastPathGuard g{*this};
+	if (!g.Entered())
+	{
+		return;
+	}
+
+	if (_timestamping_enabled.load(std::memory_order_relaxed))
+	{
+		// 网桥转发过来的帧，没有端口的硬件时间戳。
+		lwip::FrameTimestamp timestamp = lwip::FrameTimestamp::Now();
+		InputFrame(frame, &timestamp);
+		return;
+	}
+
+	InputFrame(frame, nullptr);
+}
 
-	pbuf *buf = pbuf_alloced_custom(PBUF_RAW,
-									span.Size(),
-									PBUF_REF,
-									custom_pbuf,
-									const_cast<uint8_t *>(span.Buffer()),
-									span.Size());
+void lwip::NetifWrapper::InputFrame(base::ReadOnlySpan const &frame, lwip::FrameTimestamp const *timestamp)
+{
+	pbuf *buf = lwip::InputPbuf::Alloc(frame, _outstanding_input_pbuf_count, timestamp);
 
 	buf->next = nullptr;
 
-	err_t input_result = _wrapped_obj->input(buf, _wrapped_obj.get());
+	err_t input_result = err_enum_t::ERR_OK;
+	if (_neighbour_table_enabled)
+	{
+		// 在 tcpip 线程中先学习邻居，再交给 ethernet_input.
+		input_result = tcpip_inpkt(buf,
+								   _wrapped_obj.get(),
+								   [](pbuf *p, netif *net_interface) -> err_t
+								   {
+									   reinterpret_cast<NetifWrapper *>(net_interface->state)->LearnNeighbour(p);
+									   return ethernet_input(p, net_interface);
+								   });
+	}
+	else
+	{
+		input_result = _wrapped_obj->input(buf, _wrapped_obj.get());
+	}
 	if (input_result != err_enum_t::ERR_OK)
 	{
 		// 输入发生错误，释放 pbuf 链表。
@@ -223,6 +550,162 @@ void lwip::NetifWrapper::OnInput(base::ReadOnlySpan span)
 	}
 }
 
+void lwip::NetifWrapper::SendFrame(base::ReadOnlySpan const &frame)
+{
+	if (_members.empty())
+	{
+		throw std::runtime_error{"必须先调用 Open 方法传入一个 bsp::IEthernetPort 对象"};
+	}
+
+	/* 网桥在其他网卡的接收线程中逐帧调用本方法。只持有本网卡的发送锁，不进入 lwip 的内核
+	 * 上下文，转发不用等待整个协议栈。
+	 */
+	Member &member = SelectSendingMember(frame);
+	FastPathGuard g{*this, member};
+	if (!g.Entered())
+	{
+		throw std::runtime_error{std::string{CODE_POS_STR} + "网卡已释放。"};
+	}
+
+	SendingLockGuard sending_lock_guard{*this};
+	_frame_sending_spans.clear();
+	_frame_sending_spans.push_back(frame);
+	SendSpans(member, _frame_sending_spans, frame.Size());
+}
+
+void lwip::NetifWrapper::OutputFromBridge(std::vector<base::ReadOnlySpan> const &spans, int32_t size)
+{
+	if (_members.empty())
+	{
+		throw std::runtime_error{"必须先调用 Open 方法传入一个 bsp::IEthernetPort 对象"};
+	}
+
+	Member &member = SelectSendingMember(spans[0]);
+	FastPathGuard g{*this, member};
+	if (!g.Entered())
+	{
+		throw std::runtime_error{std::string{CODE_POS_STR} + "网卡已释放。"};
+	}
+
+	SendingLockGuard sending_lock_guard{*this};
+	SendSpans(member, spans, size);
+}
+
+void lwip::NetifWrapper::InputCopiedFrame(std::vector<base::ReadOnlySpan> const &spans, int32_t size)
+{
+	FastPathGuard g{*this};
+	if (!g.Entered())
+	{
+		return;
+	}
+
+	pbuf *buf = pbuf_alloc(PBUF_RAW, static_cast<u16_t>(size), PBUF_RAM);
+	if (buf == nullptr)
+	{
+		return;
+	}
+
+	u16_t offset = 0;
+	for (base::ReadOnlySpan const &span : spans)
+	{
+		pbuf_take_at(buf, span.Buffer(), static_cast<u16_t>(span.Size()), offset);
+		offset = static_cast<u16_t>(offset + span.Size());
+	}
+
+	/* 这里处于源网卡的 linkoutput 中，已经在内核上下文里了。_wrapped_obj->input 是
+	 * tcpip_input, 开启 LWIP_TCPIP_CORE_LOCKING_INPUT 时会再次获取内核锁而死锁；同步调用
+	 * ethernet_input 又会在 lwip 发送的途中重入接收路径。所以像 loopif 一样排队，等 tcpip
+	 * 线程处理完当前的消息再输入。队列满时丢弃，不能在 tcpip 线程中等待自己的邮箱。
+	 */
+	buf->if_idx = netif_get_index(_wrapped_obj.get());
+	if (tcpip_try_callback(InputCopiedFrameFunc, buf) != err_enum_t::ERR_OK)
+	{
+		pbuf_free(buf);
+	}
+}
+
+void lwip::NetifWrapper::InputCopiedFrameFunc(void *arg)
+{
+	pbuf *p = reinterpret_cast<pbuf *>(arg);
+
+	// 排队期间网卡可能已被移除。移除也在内核上下文中进行，查得到就说明网卡还在。
+	netif *net_interface = netif_get_by_index(p->if_idx);
+	if (net_interface == nullptr)
+	{
+		pbuf_free(p);
+		return;
+	}
+
+	if (net_interface->output == NeighbourTableOutputFunc)
+	{
+		reinterpret_cast<NetifWrapper *>(net_interface->state)->LearnNeighbour(p);
+	}
+
+	if (ethernet_input(p, net_interface) != err_enum_t::ERR_OK)
+	{
+		pbuf_free(p);
+	}
+}
+
+#pragma region 时间戳
+
+void lwip::NetifWrapper::EnableTimestamping(
+	std::function<void(lwip::FrameTimestamp const &, base::ReadOnlySpan const &)> sending_timestamp_callback)
+{
+	SendingLockGuard g{*this};
+	_sending_timestamp_callback = std::move(sending_timestamp_callback);
+	_timestamping_enabled = true;
+}
+
+void lwip::NetifWrapper::DisableTimestamping()
+{
+	SendingLockGuard g{*this};
+	_timestamping_enabled = false;
+	_sending_timestamp_callback = nullptr;
+}
+
+#pragma endregion
+
+void lwip::NetifWrapper::SetBridge(lwip::Bridge *bridge)
+{
+	_bridge.store(bridge, std::memory_order_release);
+}
+
+void lwip::NetifWrapper::LimitChecksumOffload(lwip::ChecksumOffloadCapability const &capability)
+{
+	if (!_opened)
+	{
+		// 还没有添加到 lwip, 打开时初始化回调会应用限制。
+		_checksum_offload_limit = capability;
+		_checksum_offload_limited = true;
+		return;
+	}
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			_checksum_offload_limit = capability;
+			_checksum_offload_limited = true;
+			ApplyChecksumOffload();
+		});
+}
+
+void lwip::NetifWrapper::UnlimitChecksumOffload()
+{
+	if (!_opened)
+	{
+		_checksum_offload_limited = false;
+		return;
+	}
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			_checksum_offload_limited = false;
+			ApplyChecksumOffload();
+		});
+}
+
 void lwip::NetifWrapper::TryDHCP()
 {
 	if (_link_controller->DhcpHasStarted())
@@ -269,49 +752,140 @@ void lwip::NetifWrapper::TryDHCP()
 	base::console().WriteLine("通过 DHCP 获取到的默认网关：" + _cache->_gateway.ToString());
 }
 
+void lwip::NetifWrapper::OnMemberConnected(Member &member)
+{
+	FastPathGuard g{*this, member};
+	if (!g.Entered())
+	{
+		return;
+	}
+
+	if (member._link_up.exchange(true))
+	{
+		// 重复的事件。
+		return;
+	}
+
+	if (_up_member_count.fetch_add(1) == 0)
+	{
+		// 开启以太网及虚拟网卡
+		base::console().WriteLine("检测到网线插入");
+		_link_controller->SetUpLink();
+		OnLinkUp();
+	}
+}
+
+void lwip::NetifWrapper::OnMemberDisconnected(Member &member)
+{
+	FastPathGuard g{*this, member};
+	if (!g.Entered())
+	{
+		return;
+	}
+
+	if (!member._link_up.exchange(false))
+	{
+		// 重复的事件。
+		return;
+	}
+
+	member._link_down_count++;
+	if (_up_member_count.fetch_sub(1) == 1)
+	{
+		base::console().WriteLine("检测到网线断开。");
+		_link_controller->SetDownLink();
+	}
+}
+
 void lwip::NetifWrapper::SubscribeEvents()
 {
+	UnsubscribeEvents();
+
+	for (std::shared_ptr<Member> const &member_ptr : _members)
 	{
-		if (_receiving_event_unsubscribe_token != nullptr)
-		{
-			_ethernet_port->ReceivingEhternetFrameEvent().Unsubscribe(_receiving_event_unsubscribe_token);
-		}
+		Member &member = *member_ptr;
+
+		member._receiving_event_unsubscribe_token = member._ethernet_port->ReceivingEhternetFrameEvent().Subscribe(
+			[this, &member](base::ReadOnlySpan span)
+			{
+				OnInput(member, span);
+			});
 
-		_receiving_event_unsubscribe_token = _ethernet_port->ReceivingEhternetFrameEvent().Subscribe(
-			[this](base::ReadOnlySpan span)
+		member._connection_event_unsubscribe_token = member._ethernet_port->ConnectedEvent().Subscribe(
+			[this, &member]()
 			{
-				OnInput(span);
+				OnMemberConnected(member);
+			});
+
+		member._disconnection_event_unsubscribe_token = member._ethernet_port->DisconnectedEvent().Subscribe(
+			[this, &member]()
+			{
+				OnMemberDisconnected(member);
 			});
 	}
+}
 
+void lwip::NetifWrapper::UnsubscribeEvents()
+{
+	for (std::shared_ptr<Member> const &member : _members)
 	{
-		if (_connection_event_unsubscribe_token != nullptr)
+		if (member->_receiving_event_unsubscribe_token != nullptr)
 		{
-			_ethernet_port->ConnectedEvent().Unsubscribe(_connection_event_unsubscribe_token);
+			member->_ethernet_port->ReceivingEhternetFrameEvent().Unsubscribe(member->_receiving_event_unsubscribe_token);
+			member->_receiving_event_unsubscribe_token = nullptr;
 		}
 
-		_connection_event_unsubscribe_token = _ethernet_port->ConnectedEvent().Subscribe(
-			[this]()
-			{
-				// 开启以太网及虚拟网卡
-				base::console().WriteLine("检测到网线插入");
-				_link_controller->SetUpLink();
-			});
+		if (member->_connection_event_unsubscribe_token != nullptr)
+		{
+			member->_ethernet_port->ConnectedEvent().Unsubscribe(member->_connection_event_unsubscribe_token);
+			member->_connection_event_unsubscribe_token = nullptr;
+		}
+
+		if (member->_disconnection_event_unsubscribe_token != nullptr)
+		{
+			member->_ethernet_port->DisconnectedEvent().Unsubscribe(member->_disconnection_event_unsubscribe_token);
+			member->_disconnection_event_unsubscribe_token = nullptr;
+		}
 	}
+}
+
+bool lwip::NetifWrapper::WaitForInputPbufs()
+{
+	// tcpip 线程按顺序处理邮箱。屏障被执行时，之前投递的接收消息都已处理完。
+	base::task::BinarySemaphore barrier{false};
+	err_t result = tcpip_callback(
+		[](void *arg)
+		{
+			reinterpret_cast<base::task::BinarySemaphore *>(arg)->Release();
+		},
+		&barrier);
 
+	if (result == err_enum_t::ERR_OK)
 	{
-		if (_disconnection_event_unsubscribe_token != nullptr)
+		barrier.Acquire();
+	}
+
+	// 剩下的是被 lwip 暂存或被应用持有的 pbuf, 例如 TCP 乱序队列和未读的数据。
+	uint32_t timeout = _input_pbuf_releasing_timeout.load();
+	uint32_t waited_milliseconds = 0;
+	while (_outstanding_input_pbuf_count->load() != 0)
+	{
+		if (waited_milliseconds >= timeout)
 		{
-			_ethernet_port->DisconnectedEvent().Unsubscribe(_disconnection_event_unsubscribe_token);
+			return false;
 		}
 
-		_disconnection_event_unsubscribe_token = _ethernet_port->DisconnectedEvent().Subscribe(
-			[this]()
-			{
-				base::console().WriteLine("检测到网线断开。");
-				_link_controller->SetDownLink();
-			});
+		base::task::Delay(std::chrono::milliseconds{1});
+		waited_milliseconds++;
+		if (waited_milliseconds % 1000 == 0)
+		{
+			base::console().WriteLine(_name + " 等待 " +
+									  std::to_string(_outstanding_input_pbuf_count->load()) +
+									  " 个接收 pbuf 被释放。");
+		}
 	}
+
+	return true;
 }
 
 netif *lwip::NetifWrapper::WrappedObj() const
@@ -336,30 +910,57 @@ lwip::NetifWrapper::~NetifWrapper()
 
 void lwip::NetifWrapper::Dispose()
 {
-	if (_disposed)
+	if (_disposed.exchange(true))
 	{
 		return;
 	}
 
-	_disposed = true;
-
-	if (_receiving_event_unsubscribe_token != nullptr)
+	// 设置 _disposed 后新进入的收发路径会立刻退出。再等待已经进入的收发路径结束。
+	UnsubscribeEvents();
+	while (_in_flight_count.load() != 0)
 	{
-		_ethernet_port->ReceivingEhternetFrameEvent().Unsubscribe(_receiving_event_unsubscribe_token);
+		base::task::Delay(std::chrono::milliseconds{1});
 	}
 
-	if (_connection_event_unsubscribe_token != nullptr)
+	for (std::shared_ptr<Member> const &member : _members)
 	{
-		_ethernet_port->ConnectedEvent().Unsubscribe(_connection_event_unsubscribe_token);
+		while (member->_in_flight_count.load() != 0)
+		{
+			base::task::Delay(std::chrono::milliseconds{1});
+		}
 	}
 
-	if (_disconnection_event_unsubscribe_token != nullptr)
+	if (!_opened)
 	{
-		_ethernet_port->DisconnectedEvent().Unsubscribe(_disconnection_event_unsubscribe_token);
+		// 没有打开过，没有线程要等待，也没有添加 netif.
+		return;
 	}
 
 	_link_state_detecting_thread_func_exited.Acquire();
-	netif_remove(_wrapped_obj.get());
+
+	// 移除后 lwip 不会再选择本网卡发送。linkoutput 在内核上下文中调用，不会与移除同时进行。
+	lwip::TcpIpCall(
+		[&]()
+		{
+			netif_remove(_wrapped_obj.get());
+		});
+
+	if (!WaitForInputPbufs())
+	{
+		base::console().WriteLine(_name + " 等待接收 pbuf 被释放超时，还有 " +
+								  std::to_string(_outstanding_input_pbuf_count->load()) +
+								  " 个 pbuf 引用着以太网端口的内存。");
+	}
+}
+
+void lwip::NetifWrapper::SetInputPbufReleasingTimeout(uint32_t timeout)
+{
+	_input_pbuf_releasing_timeout.store(timeout);
+}
+
+int32_t lwip::NetifWrapper::OutstandingInputPbufCount() const
+{
+	return _outstanding_input_pbuf_count->load();
 }
 
 #pragma endregion
@@ -376,19 +977,64 @@ void lwip::NetifWrapper::Open(base::ethernet::IEthernetPort *ethernet_port,
 							  base::IPAddress const &gateway,
 							  int32_t mtu)
 {
-	_ethernet_port = ethernet_port;
+	if (ethernet_port == nullptr)
+	{
+		throw std::invalid_argument{CODE_POS_STR + "ethernet_port 不能是空指针。"};
+	}
+
+	Open(std::vector<base::ethernet::IEthernetPort *>{ethernet_port},
+		 lwip::BondingHashPolicy::L2,
+		 mac,
+		 ip_address,
+		 netmask,
+		 gateway,
+		 mtu);
+}
+
+void lwip::NetifWrapper::Open(std::vector<base::ethernet::IEthernetPort *> const &ethernet_ports,
+							  lwip::BondingHashPolicy hash_policy,
+							  base::Mac const &mac,
+							  base::IPAddress const &ip_address,
+							  base::IPAddress const &netmask,
+							  base::IPAddress const &gateway,
+							  int32_t mtu)
+{
+	if (ethernet_ports.empty())
+	{
+		throw std::invalid_argument{CODE_POS_STR + "ethernet_ports 不能为空。"};
+	}
+
+	for (base::ethernet::IEthernetPort *ethernet_port : ethernet_ports)
+	{
+		if (ethernet_port == nullptr)
+		{
+			throw std::invalid_argument{CODE_POS_STR + "ethernet_ports 中不能含有空指针。"};
+		}
+	}
+
+	/* 旧成员的事件订阅捕获了成员的引用，必须在替换成员之前取消，否则旧端口的事件会访问
+	 * 已经释放的成员。
+	 */
+	UnsubscribeEvents();
+	_members.clear();
+	for (base::ethernet::IEthernetPort *ethernet_port : ethernet_ports)
+	{
+		_members.push_back(std::shared_ptr<Member>{new Member{ethernet_port}});
+	}
+
+	_hash_policy = hash_policy;
 	_cache->_mac = mac;
 	_cache->_ip_address = ip_address;
 	_cache->_netmask = netmask;
 	_cache->_gateway = gateway;
 	_cache->_mtu = mtu;
 
-	if (_ethernet_port == nullptr)
+	for (std::shared_ptr<Member> const &member : _members)
 	{
-		throw std::invalid_argument{CODE_POS_STR + "ethernet_port 不能是空指针。"};
+		member->_ethernet_port->Open(_cache->_mac);
 	}
 
-	_ethernet_port->Open(_cache->_mac);
+	NegotiateChecksumOffload();
 	TcpIpInitialize();
 
 	ip_addr_t ip_addr_t_ip_address{};
@@ -445,9 +1091,30 @@ void lwip::NetifWrapper::Open(base::ethernet::IEthernetPort *ethernet_port,
 						LinkStateDetectingThreadFunc();
 					});
 
+	_opened = true;
 	SubscribeEvents();
 }
 
+std::vector<lwip::BondingMemberStatistics> lwip::NetifWrapper::MemberStatistics() const
+{
+	std::vector<lwip::BondingMemberStatistics> result;
+	result.reserve(_members.size());
+	for (std::shared_ptr<Member> const &member : _members)
+	{
+		lwip::BondingMemberStatistics statistics{};
+		statistics.link_up = member->_link_up;
+		statistics.sent_frame_count = member->_sent_frame_count;
+		statistics.sent_byte_count = member->_sent_byte_count;
+		statistics.sending_error_count = member->_sending_error_count;
+		statistics.received_frame_count = member->_received_frame_count;
+		statistics.received_byte_count = member->_received_byte_count;
+		statistics.link_down_count = member->_link_down_count;
+		result.push_back(statistics);
+	}
+
+	return result;
+}
+
 #pragma region 地址
 
 base::Mac lwip::NetifWrapper::Mac() const
@@ -547,6 +1214,313 @@ void lwip::NetifWrapper::ClearAllAddress()
 
 #pragma endregion
 
+#pragma region ARP
+
+void lwip::NetifWrapper::OnLinkUp()
+{
+	lwip::TcpIpCall(
+		[&]()
+		{
+			DoApplyStaticArpEntries();
+			DoSendGratuitousArp();
+			DoPrewarmArpCache();
+		});
+}
+
+void lwip::NetifWrapper::DoApplyStaticArpEntries()
+{
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+	for (std::pair<base::IPAddress, base::Mac> const &entry : _static_arp_entries)
+	{
+		ip4_addr_t ip{};
+		ip << entry.first;
+
+		eth_addr mac{};
+		mac << entry.second;
+
+		etharp_add_static_entry(&ip, &mac);
+	}
+#endif
+}
+
+void lwip::NetifWrapper::DoSendGratuitousArp()
+{
+	if (!netif_is_up(_wrapped_obj.get()) || ip4_addr_isany_val(*netif_ip4_addr(_wrapped_obj.get())))
+	{
+		return;
+	}
+
+	etharp_gratuitous(_wrapped_obj.get());
+}
+
+void lwip::NetifWrapper::DoPrewarmArpCache()
+{
+	if (!netif_is_up(_wrapped_obj.get()))
+	{
+		return;
+	}
+
+	for (base::IPAddress const &peer : _arp_prewarm_peers)
+	{
+		ip4_addr_t ip{};
+		ip << peer;
+
+		// 只发请求，不等待。回复到达后 lwip 的 ARP 表和邻居表都会学习到。
+		etharp_request(_wrapped_obj.get(), &ip);
+	}
+}
+
+void lwip::NetifWrapper::LearnNeighbour(pbuf *p)
+{
+	// 以太网头 14 字节，IPv4 over Ethernet 的 ARP 报文 28 字节。
+	if (_neighbour_table == nullptr || p->len < 42)
+	{
+		return;
+	}
+
+	uint8_t const *frame = reinterpret_cast<uint8_t const *>(p->payload);
+	bool is_arp = frame[12] == 0x08 && frame[13] == 0x06;
+	bool is_ethernet_ipv4 = frame[14] == 0x00 && frame[15] == 0x01 &&
+							frame[16] == 0x08 && frame[17] == 0x00 &&
+							frame[18] == 6 && frame[19] == 4;
+
+	if (!is_arp || !is_ethernet_ipv4)
+	{
+		return;
+	}
+
+	eth_addr sender_mac{};
+	std::memcpy(sender_mac.addr, frame + 22, 6);
+
+	ip4_addr_t sender_ip{};
+	std::memcpy(&sender_ip.addr, frame + 28, 4);
+
+	// 只有本网卡子网中的地址才可能成为下一跳。
+	if (!ip4_addr_netcmp(&sender_ip, netif_ip4_addr(_wrapped_obj.get()), netif_ip4_netmask(_wrapped_obj.get())))
+	{
+		return;
+	}
+
+	ip4_addr_t target_ip{};
+	std::memcpy(&target_ip.addr, frame + 38, 4);
+
+	/* 与 lwip 的 etharp_input 一样，只有发给本机的 ARP 报文才插入新表项，其他报文只刷新
+	 * 已有的表项。否则子网中任何主机都可以用 ARP 报文挤出表项，或者为不存在的地址伪造表项。
+	 */
+	if (ip4_addr_cmp(&target_ip, netif_ip4_addr(_wrapped_obj.get())))
+	{
+		_neighbour_table->Learn(sender_ip, sender_mac, sys_now(), false);
+	}
+	else
+	{
+		_neighbour_table->Refresh(sender_ip, sender_mac, sys_now());
+	}
+}
+
+err_t lwip::NetifWrapper::NeighbourTableOutput(pbuf *p, ip4_addr_t const *ipaddr)
+{
+	netif *net_interface = _wrapped_obj.get();
+	if (_neighbour_table == nullptr ||
+		ip4_addr_isbroadcast(ipaddr, net_interface) ||
+		ip4_addr_ismulticast(ipaddr) ||
+		ip4_addr_islinklocal(ipaddr))
+	{
+		return etharp_output(net_interface, p, ipaddr);
+	}
+
+	// 与 etharp_output 一样确定下一跳。
+	ip4_addr_t const *next_hop = ipaddr;
+	if (!ip4_addr_netcmp(ipaddr, netif_ip4_addr(net_interface), netif_ip4_netmask(net_interface)))
+	{
+		next_hop = lwip::net_if_slot().Routes().FindGateway(net_interface, ipaddr);
+		if (next_hop == nullptr)
+		{
+			next_hop = netif_ip4_gw(net_interface);
+		}
+
+		if (ip4_addr_isany_val(*next_hop))
+		{
+			// 没有网关，交给 etharp_output 返回错误。
+			return etharp_output(net_interface, p, ipaddr);
+		}
+	}
+
+	eth_addr const *destination_mac = _neighbour_table->Find(*next_hop, sys_now());
+	if (destination_mac == nullptr)
+	{
+		return etharp_output(net_interface, p, ipaddr);
+	}
+
+	return ethernet_output(net_interface,
+						   p,
+						   reinterpret_cast<eth_addr const *>(net_interface->hwaddr),
+						   destination_mac,
+						   ETHTYPE_IP);
+}
+
+err_t lwip::NetifWrapper::NeighbourTableOutputFunc(netif *net_interface, pbuf *p, ip4_addr_t const *ipaddr)
+{
+	return reinterpret_cast<NetifWrapper *>(net_interface->state)->NeighbourTableOutput(p, ipaddr);
+}
+
+void lwip::NetifWrapper::AddStaticArpEntry(base::IPAddress const &ip_address, base::Mac const &mac)
+{
+	lwip::TcpIpCall(
+		[&]()
+		{
+			DoAddStaticArpEntry(ip_address, mac);
+		});
+}
+
+void lwip::NetifWrapper::DoAddStaticArpEntry(base::IPAddress const &ip_address, base::Mac const &mac)
+{
+	bool found = false;
+	for (std::pair<base::IPAddress, base::Mac> &entry : _static_arp_entries)
+	{
+		if (entry.first == ip_address)
+		{
+			entry.second = mac;
+			found = true;
+			break;
+		}
+	}
+
+	if (!found)
+	{
+		_static_arp_entries.push_back(std::pair<base::IPAddress, base::Mac>{ip_address, mac});
+	}
+
+	ip4_addr_t ip{};
+	ip << ip_address;
+
+	eth_addr eth_mac{};
+	eth_mac << mac;
+
+	if (_neighbour_table != nullptr)
+	{
+		_neighbour_table->Learn(ip, eth_mac, sys_now(), true);
+	}
+
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+	if (netif_is_up(_wrapped_obj.get()))
+	{
+		etharp_add_static_entry(&ip, &eth_mac);
+	}
+#endif
+}
+
+bool lwip::NetifWrapper::RemoveStaticArpEntry(base::IPAddress const &ip_address)
+{
+	bool removed = false;
+	lwip::TcpIpCall(
+		[&]()
+		{
+			removed = DoRemoveStaticArpEntry(ip_address);
+		});
+
+	return removed;
+}
+
+bool lwip::NetifWrapper::DoRemoveStaticArpEntry(base::IPAddress const &ip_address)
+{
+	for (auto it = _static_arp_entries.begin(); it != _static_arp_entries.end(); it++)
+	{
+		if (it->first == ip_address)
+		{
+			_static_arp_entries.erase(it);
+
+			ip4_addr_t ip{};
+			ip << ip_address;
+
+			if (_neighbour_table != nullptr)
+			{
+				_neighbour_table->Remove(ip);
+			}
+
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+			etharp_remove_static_entry(&ip);
+#endif
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void lwip::NetifWrapper::SendGratuitousArp()
+{
+	lwip::TcpIpCall(
+		[&]()
+		{
+			DoSendGratuitousArp();
+		});
+}
+
+void lwip::NetifWrapper::SetArpPrewarmPeers(std::vector<base::IPAddress> const &peers)
+{
+	lwip::TcpIpCall(
+		[&]()
+		{
+			_arp_prewarm_peers = peers;
+		});
+}
+
+void lwip::NetifWrapper::PrewarmArpCache()
+{
+	lwip::TcpIpCall(
+		[&]()
+		{
+			DoPrewarmArpCache();
+		});
+}
+
+void lwip::NetifWrapper::EnableNeighbourTable(uint32_t capacity, uint32_t aging_time)
+{
+	std::shared_ptr<lwip::NeighbourTable> table{new lwip::NeighbourTable{capacity, aging_time}};
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			for (std::pair<base::IPAddress, base::Mac> const &entry : _static_arp_entries)
+			{
+				ip4_addr_t ip{};
+				ip << entry.first;
+
+				eth_addr mac{};
+				mac << entry.second;
+
+				table->Learn(ip, mac, sys_now(), true);
+			}
+
+			_neighbour_table = table;
+			_neighbour_table_enabled = true;
+
+			if (_wrapped_obj->output != nullptr)
+			{
+				// 已经打开了，替换 output 函数。还没打开的话，InitializationCallbackFunc 会设置。
+				_wrapped_obj->output = NeighbourTableOutputFunc;
+			}
+		});
+}
+
+lwip::NeighbourTableStatistics lwip::NetifWrapper::NeighbourStatistics() const
+{
+	lwip::NeighbourTableStatistics statistics{};
+	lwip::TcpIpCall(
+		[&]()
+		{
+			if (_neighbour_table != nullptr)
+			{
+				statistics = _neighbour_table->Statistics();
+			}
+		});
+
+	return statistics;
+}
+
+#pragma endregion
+
 #pragma region 公共 DHCP
 
 bool lwip::NetifWrapper::HasGotAddressesByDHCP()
@@ -4,12 +4,22 @@
 #include "base/net/IPAddress.h"
 #include "base/net/Mac.h"
 #include "base/task/BinarySemaphore.h"
+#include "lwip-wrapper/BondingHashPolicy.h"
+#include "lwip-wrapper/BondingMemberStatistics.h"
+#include "lwip-wrapper/ChecksumOffloadCapability.h"
+#include "lwip-wrapper/FrameTimestamp.h"
+#include "lwip-wrapper/NeighbourTableStatistics.h"
 #include "lwip/netif.h"
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace lwip
 {
+	class Bridge;
+	class NeighbourTable;
+
 	/// @brief lwip 的 netif 的包装器。
 	/// @warning 本类依赖 netif 的 state 字段。使用本类后，禁止修改此字段。
 	class NetifWrapper :
@@ -17,16 +27,80 @@ namespace lwip
 	{
 	private:
 		std::atomic_bool _disposed = false;
+
+		/// @brief Open 是否已经成功添加了 netif 并启动了链路状态检测线程。
+		std::atomic_bool _opened = false;
+
+		/// @brief 不属于某个成员端口的收发路径的个数，即 linkoutput 和网桥交给本机的帧。
+		/// @note 收发路径进入时加 1, 然后检查 _disposed, 离开时减 1. Dispose 先设置 _disposed,
+		/// 再等待本计数和每个成员的计数都归零，之后就不会再有收发路径访问成员端口。收发路径上
+		/// 没有锁。
+		///
+		/// @note 成员端口的接收、链路事件和发往该成员的帧登记在成员自己的计数上，各端口的
+		/// 接收线程不会争用同一个缓存行。
+		std::atomic_int32_t _in_flight_count = 0;
+
+		/// @brief 接收时创建的，还没有被 lwip 释放的 pbuf 的个数。
+		/// @note 由每个接收 pbuf 共同持有。Dispose 等待超时返回后，本对象可能先于这些 pbuf
+		/// 析构，pbuf 释放时仍然要递减计数。
+		std::shared_ptr<std::atomic_int32_t> _outstanding_input_pbuf_count{new std::atomic_int32_t{0}};
+
+		/// @brief Dispose 等待接收 pbuf 被释放的最长时间。单位：毫秒。
+		std::atomic_uint32_t _input_pbuf_releasing_timeout = 5000;
+
+		class FastPathGuard;
+
 		std::atomic_bool _dhcp_enabled = false;
 		std::unique_ptr<netif> _wrapped_obj{new netif{}};
-		base::ethernet::IEthernetPort *_ethernet_port = nullptr;
 		std::string _name;
 		base::task::BinarySemaphore _link_state_detecting_thread_func_exited{false};
-		std::shared_ptr<base::IIdToken> _receiving_event_unsubscribe_token;
-		std::shared_ptr<base::IIdToken> _connection_event_unsubscribe_token;
-		std::shared_ptr<base::IIdToken> _disconnection_event_unsubscribe_token;
+
+		/// @brief lwip 发送时使用。只在 lwip 内核上下文中访问。
 		std::vector<base::ReadOnlySpan> _sending_spans{};
 
+		/// @brief 发送锁。发送路径之间互斥地使用成员端口，与 lwip 的内核锁无关。
+		/// @note 可以在持有内核锁时获取发送锁，反过来禁止。
+		base::task::BinarySemaphore _sending_lock{true};
+		class SendingLockGuard;
+
+		/// @brief SendFrame 使用。只在持有发送锁时访问。
+		std::vector<base::ReadOnlySpan> _frame_sending_spans{};
+
+		/// @brief 成员端口。只有一个成员时就是普通的网卡，有多个成员时是聚合网卡。
+		class Member;
+		std::vector<std::shared_ptr<Member>> _members;
+		lwip::BondingHashPolicy _hash_policy = lwip::BondingHashPolicy::L2;
+
+		/// @brief 链路接通的成员端口个数。
+		std::atomic_int _up_member_count = 0;
+
+		/// @brief 所有成员端口都支持的校验和卸载能力。
+		lwip::ChecksumOffloadCapability _checksum_offload_capability{};
+
+		/// @brief 网桥要求的校验和卸载能力的上限。_checksum_offload_limited 为 false 时不限制。
+		/// 打开后只在 lwip 内核上下文中访问。
+		lwip::ChecksumOffloadCapability _checksum_offload_limit{};
+		bool _checksum_offload_limited = false;
+
+		/// @brief 本网卡所在的网桥。不在网桥中时为空指针。
+		std::atomic<lwip::Bridge *> _bridge = nullptr;
+
+		/// @brief 固定的 ARP 表项。只在 lwip 内核上下文中访问。
+		std::vector<std::pair<base::IPAddress, base::Mac>> _static_arp_entries;
+
+		/// @brief 链路接通后要预先解析 MAC 地址的邻居。只在 lwip 内核上下文中访问。
+		std::vector<base::IPAddress> _arp_prewarm_peers;
+
+		/// @brief 邻居表。没有开启时为空指针。只在 lwip 内核上下文中访问。
+		std::shared_ptr<lwip::NeighbourTable> _neighbour_table;
+		std::atomic_bool _neighbour_table_enabled = false;
+
+		/// @brief 是否在接收时记录时间戳。
+		std::atomic_bool _timestamping_enabled = false;
+
+		/// @brief 发送时间戳回调。没有开启时间戳时为空。只在持有发送锁时访问。
+		std::function<void(lwip::FrameTimestamp const &, base::ReadOnlySpan const &)> _sending_timestamp_callback;
+
 		class LinkController;
 		std::shared_ptr<LinkController> _link_controller = nullptr;
 
@@ -36,16 +110,87 @@ namespace lwip
 
 		void InitializationCallbackFunc();
 
+		/// @brief 查询所有成员端口的校验和卸载能力。
+		void NegotiateChecksumOffload();
+
+		/// @brief 按校验和卸载能力和网桥要求的上限设置 lwip 对本网卡的校验和计算。
+		/// @note 打开后需要在 lwip 内核上下文中调用。
+		void ApplyChecksumOffload();
+
 		/// @brief 使用本网卡发送 pbuf 链表。
 		/// @param p
 		void SendPbuf(pbuf *p);
 
+		/// @brief 为要发送的帧选择成员端口。
+		/// @param first_segment 帧的第一段。要包含以太网头，最好还包含 IP 头和 TCP/UDP 头。
+		/// @return
+		Member &SelectSendingMember(base::ReadOnlySpan const &first_segment);
+
+		/// @brief 用指定的成员端口发送帧。需要持有发送锁。
+		/// @param member
+		/// @param spans 帧的各段。
+		/// @param size 帧的总字节数。
+		void SendSpans(Member &member, std::vector<base::ReadOnlySpan> const &spans, int32_t size);
+
+		friend class lwip::Bridge;
+
+		/// @brief 发送网桥为本机协议栈发出的帧选择的出口是本网卡时，由网桥调用。
+		/// @note 在 lwip 内核上下文中调用。
+		/// @param spans 帧的各段。
+		/// @param size 帧的总字节数。
+		void OutputFromBridge(std::vector<base::ReadOnlySpan> const &spans, int32_t size);
+
+		/// @brief 把另一张本机网卡的协议栈发给本网卡的帧拷贝后输入 lwip.
+		/// @note 由网桥在 lwip 内核上下文中调用。帧的内存在发送返回后就会被释放，所以必须拷贝。
+		/// 拷贝经 tcpip 线程的邮箱排队输入，不在调用中同步输入。
+		/// @param spans 帧的各段。
+		/// @param size 帧的总字节数。
+		void InputCopiedFrame(std::vector<base::ReadOnlySpan> const &spans, int32_t size);
+
+		/// @brief 在 tcpip 线程中输入 InputCopiedFrame 排队的帧。
+		/// @param arg pbuf. if_idx 是目的网卡的索引。
+		static void InputCopiedFrameFunc(void *arg);
+
+		/// @brief 将一个以太网帧输入 lwip 协议栈。
+		/// @param frame
+		/// @param timestamp 接收时间戳。为空指针表示不记录。
+		void InputFrame(base::ReadOnlySpan const &frame, lwip::FrameTimestamp const *timestamp);
+
 		/// @brief 检测链接状态的线程函数。
 		void LinkStateDetectingThreadFunc();
 
-		void OnInput(base::ReadOnlySpan span);
+		void OnInput(Member &member, base::ReadOnlySpan span);
+		void OnMemberConnected(Member &member);
+		void OnMemberDisconnected(Member &member);
 		void TryDHCP();
 		void SubscribeEvents();
+		void UnsubscribeEvents();
+
+		/// @brief 等待 tcpip 线程处理完邮箱中已有的消息，以及被 lwip 持有的接收 pbuf 全部释放。
+		/// @return 接收 pbuf 在超时前全部释放返回 true, 超时返回 false.
+		bool WaitForInputPbufs();
+
+		/// @brief 链路接通后重新固定 ARP 表项，发送免费 ARP, 预热 ARP 缓存。
+		void OnLinkUp();
+
+		/// @brief 以下 Do 开头的方法需要在 lwip 内核上下文中调用。
+		void DoApplyStaticArpEntries();
+		void DoSendGratuitousArp();
+		void DoPrewarmArpCache();
+		void DoAddStaticArpEntry(base::IPAddress const &ip_address, base::Mac const &mac);
+		bool DoRemoveStaticArpEntry(base::IPAddress const &ip_address);
+
+		/// @brief 从接收到的 ARP 帧中学习邻居。在 tcpip 线程中调用。
+		/// @param p
+		void LearnNeighbour(pbuf *p);
+
+		/// @brief 开启邻居表后使用的 netif 的 output 函数。在 tcpip 线程中调用。
+		/// @param p
+		/// @param ipaddr
+		/// @return
+		err_t NeighbourTableOutput(pbuf *p, ip4_addr_t const *ipaddr);
+
+		static err_t NeighbourTableOutputFunc(netif *net_interface, pbuf *p, ip4_addr_t const *ipaddr);
 
 	public:
 #pragma region 生命周期
@@ -53,7 +198,27 @@ namespace lwip
 		NetifWrapper(std::string const &name);
 		~NetifWrapper();
 
+		/// @brief 释放资源。
+		/// @note 返回时，正在执行的收发路径都已结束，netif 已从 lwip 中移除。接收时创建的 pbuf
+		/// 引用着以太网端口的内存，本方法最多等待 SetInputPbufReleasingTimeout 设置的时间让
+		/// 它们被释放。UdpEndpoint 和 TcpConnection 交给应用的都是拷贝，不需要等待应用；
+		/// 需要等待的只有 lwip 自身暂存的 pbuf, 例如乱序的 TCP 报文段和未重组完的分片，以及
+		/// 应用直接用 raw API 或 socket 持有的 pbuf.
+		///
+		/// @note 返回后 OutstandingInputPbufCount 为 0 时才可以释放以太网端口。超时返回时
+		/// 会打印剩余的个数，这时以太网端口的内存要保持有效，直到计数归零。
+		///
+		/// @note 禁止在 tcpip 线程中调用。
 		void Dispose() override;
+
+		/// @brief 设置 Dispose 等待接收 pbuf 被释放的最长时间。
+		/// @param timeout 单位：毫秒。
+		void SetInputPbufReleasingTimeout(uint32_t timeout);
+
+		/// @brief 接收时创建的，还没有被释放的 pbuf 的个数。
+		/// @note 这些 pbuf 引用着以太网端口的内存。
+		/// @return
+		int32_t OutstandingInputPbufCount() const;
 #pragma endregion
 
 		/// @brief 获取被包装对象的指针。
@@ -76,6 +241,84 @@ namespace lwip
 				  base::IPAddress const &gateway,
 				  int32_t mtu);
 
+		/// @brief 将多个以太网端口聚合成一张网卡打开。
+		/// @note 发送时按流哈希把帧分配到链路接通的成员端口上，所有成员端口接收到的帧都会
+		/// 输入本网卡。成员端口链路断开后，原本经它发送的流会立刻改由其他成员端口发送，
+		/// 网卡的 IP 地址不变。只有所有成员端口都断开时才会通知 lwip 链路断开。
+		///
+		/// @note 所有成员端口都使用同一个 MAC 地址，所以交换机一侧需要配置为静态链路聚合。
+		///
+		/// @param ethernet_ports 成员端口。不能为空，也不能含有空指针。
+		/// @param hash_policy 发送时使用的流哈希策略。
+		/// @param mac
+		/// @param ip_address
+		/// @param netmask
+		/// @param gateway
+		/// @param mtu
+		void Open(std::vector<base::ethernet::IEthernetPort *> const &ethernet_ports,
+				  lwip::BondingHashPolicy hash_policy,
+				  base::Mac const &mac,
+				  base::IPAddress const &ip_address,
+				  base::IPAddress const &netmask,
+				  base::IPAddress const &gateway,
+				  int32_t mtu);
+
+		/// @brief 直接发送一个完整的以太网帧，不经过 lwip.
+		/// @note 供网桥转发使用，可以在任意线程中调用。只与本网卡的其他发送互斥，不进入 lwip
+		/// 的内核上下文。禁止在本网卡的发送时间戳回调中调用。
+		/// @param frame
+		void SendFrame(base::ReadOnlySpan const &frame);
+
+		/// @brief 将一个以太网帧输入 lwip 协议栈。
+		/// @note 帧的内存由调用者拥有，lwip 会引用而不是拷贝。
+		/// @param frame
+		void InputFrame(base::ReadOnlySpan const &frame);
+
+		/// @brief 设置本网卡所在的网桥。
+		/// @note 由 NetifSlot 调用。传入空指针表示离开网桥。
+		/// @param bridge
+		void SetBridge(lwip::Bridge *bridge);
+
+		/// @brief 限制校验和卸载能力，只卸载 capability 中的项目。
+		/// @note 由 NetifSlot 调用。网桥在端口之间原样转发帧，一个端口卸载了的校验和，
+		/// 帧从另一个端口发出或被另一张网卡接收时不会再有人计算，所以网桥中的网卡只能卸载
+		/// 所有端口都支持的项目。
+		/// @param capability
+		void LimitChecksumOffload(lwip::ChecksumOffloadCapability const &capability);
+
+		/// @brief 取消 LimitChecksumOffload 的限制，恢复为成员端口支持的卸载能力。
+		void UnlimitChecksumOffload();
+
+		/// @brief 获取打开时协商得到的校验和卸载能力。
+		/// @note 只有 lwip 开启了 LWIP_CHECKSUM_CTRL_PER_NETIF 时卸载才会生效。
+		/// @return
+		lwip::ChecksumOffloadCapability ChecksumOffloadCapability() const
+		{
+			return _checksum_offload_capability;
+		}
+
+#pragma region 时间戳
+		/// @brief 开启帧时间戳。
+		/// @note 成员端口实现了 lwip::IFrameTimestamping 时使用硬件时间戳，否则使用软件时钟。
+		/// 接收时间戳记录在 pbuf 中，通过 lwip::TryGetFrameTimestamp 读取。UdpEndpoint 和
+		/// PbufChain 会替应用读取。
+		///
+		/// @note 禁止在发送时间戳回调中调用。
+		///
+		/// @param sending_timestamp_callback 每发送一帧就在发送的线程中调用一次，传入发送
+		/// 时间戳和帧的第一段。调用时持有本网卡的发送锁。可以为空。回调禁止阻塞。
+		void EnableTimestamping(
+			std::function<void(lwip::FrameTimestamp const &, base::ReadOnlySpan const &)> sending_timestamp_callback);
+
+		/// @brief 关闭帧时间戳。关闭后收发路径上没有任何额外开销。
+		/// @note 禁止在发送时间戳回调中调用。
+		void DisableTimestamping();
+#pragma endregion
+
+		/// @brief 获取每个成员端口的统计数据。
+		/// @return 顺序与 Open 时传入的成员端口顺序相同。
+		std::vector<lwip::BondingMemberStatistics> MemberStatistics() const;
+
 #pragma region 地址
 		base::Mac Mac() const;
 		void SetMac(base::Mac const &o);
@@ -105,6 +348,46 @@ namespace lwip
 		void ClearAllAddress();
 #pragma endregion
 
+#pragma region ARP
+		/// @brief 固定一个 ARP 表项。
+		/// @note 固定的表项不会老化。lwip 在链路断开时会清除本网卡的所有 ARP 表项，本类会在
+		/// 链路重新接通时重新固定，所以链路抖动后发往这些邻居的第一个包不需要等待 ARP.
+		/// lwip 开启了 ETHARP_SUPPORT_STATIC_ENTRIES 时写入 lwip 的 ARP 表，否则只写入邻居表，
+		/// 需要先调用 EnableNeighbourTable 才会生效。
+		/// @param ip_address
+		/// @param mac
+		void AddStaticArpEntry(base::IPAddress const &ip_address, base::Mac const &mac);
+
+		/// @brief 移除一个固定的 ARP 表项。
+		/// @param ip_address
+		/// @return 移除成功返回 true, 表项不存在返回 false.
+		bool RemoveStaticArpEntry(base::IPAddress const &ip_address);
+
+		/// @brief 发送免费 ARP, 让邻居更新本网卡的 MAC 地址。
+		/// @note 链路接通时会自动发送。修改 IP 地址时 lwip 自己会发送。
+		void SendGratuitousArp();
+
+		/// @brief 设置链路接通后要预先解析 MAC 地址的邻居。
+		/// @param peers
+		void SetArpPrewarmPeers(std::vector<base::IPAddress> const &peers);
+
+		/// @brief 立刻向 SetArpPrewarmPeers 设置的邻居发送 ARP 请求。
+		/// @note 链路接通时会自动调用。
+		void PrewarmArpCache();
+
+		/// @brief 开启邻居表。
+		/// @note 邻居表是 lwip 的 ARP 表前面的一级缓存，是一个大容量的哈希表，从收到的 ARP
+		/// 帧中学习。发送时下一跳在邻居表中则直接封装以太网头发送，否则交给 lwip 的 ARP 处理。
+		/// 重复调用会用新的容量和老化时间重建邻居表。
+		/// @param capacity 表项个数。
+		/// @param aging_time 老化时间，单位：毫秒。
+		void EnableNeighbourTable(uint32_t capacity, uint32_t aging_time = 300 * 1000);
+
+		/// @brief 获取邻居表的统计数据。没有开启邻居表时全为 0.
+		/// @return
+		lwip::NeighbourTableStatistics NeighbourStatistics() const;
+#pragma endregion
+
 #pragma region 公共 DHCP
 		/// @brief 检查本次启动 DHCP 后 IP 地址是否被 DHCP 提供了。
 		/// @return 如果 DHCP 提供了 IP 地址，则返回 true, 否则返回 false.
@@ -0,0 +1,86 @@
+#include "PbufChain.h"
+
+lwip::PbufChain::PbufChain(pbuf *head, std::function<void(pbuf *)> releaser)
+	: _head(head),
+	  _releaser(std::move(releaser))
+{
+	lwip::TryGetFrameTimestamp(_head, _timestamp);
+}
+
+lwip::PbufChain::PbufChain(pbuf *head, lwip::FrameTimestamp const &timestamp, std::function<void(pbuf *)> releaser)
+	: _head(head),
+	  _releaser(std::move(releaser)),
+	  _timestamp(timestamp)
+{
+}
+
+lwip::PbufChain::PbufChain(PbufChain &&o)
+	: _head(o._head),
+	  _releaser(std::move(o._releaser)),
+	  _timestamp(o._timestamp)
+{
+	o._head = nullptr;
+}
+
+lwip::PbufChain &lwip::PbufChain::operator=(PbufChain &&o)
+{
+	if (this == &o)
+	{
+		return *this;
+	}
+
+	Release();
+	_head = o._head;
+	_releaser = std::move(o._releaser);
+	_timestamp = o._timestamp;
+	o._head = nullptr;
+	return *this;
+}
+
+lwip::PbufChain::~PbufChain()
+{
+	Release();
+}
+
+int32_t lwip::PbufChain::Size() const
+{
+	if (_head == nullptr)
+	{
+		return 0;
+	}
+
+	return _head->tot_len;
+}
+
+std::vector<base::ReadOnlySpan> lwip::PbufChain::Spans() const
+{
+	std::vector<base::ReadOnlySpan> spans;
+	for (pbuf *current = _head; current != nullptr; current = current->next)
+	{
+		spans.push_back(base::ReadOnlySpan{
+			reinterpret_cast<uint8_t const *>(current->payload),
+			current->len,
+		});
+	}
+
+	return spans;
+}
+
+void lwip::PbufChain::Release()
+{
+	if (_head == nullptr)
+	{
+		return;
+	}
+
+	pbuf *head = _head;
+	_head = nullptr;
+	if (_releaser != nullptr)
+	{
+		_releaser(head);
+		_releaser = nullptr;
+		return;
+	}
+
+	pbuf_free(head);
+}
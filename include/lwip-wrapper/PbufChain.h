@@ -0,0 +1,84 @@
+#pragma once
+#include "base/net/Mac.h"
+#include "lwip-wrapper/FrameTimestamp.h"
+#include "lwip/pbuf.h"
+#include <functional>
+#include <vector>
+
+namespace lwip
+{
+	/// @brief 持有一个 pbuf 链表，以只读视图的形式访问其中的数据，不拷贝。
+	/// @note 只能移动，不能复制。析构时如果还没有释放则自动释放。
+	///
+	/// @warning 释放会调用 lwip 的 raw API, 所以 Release 和析构都必须在 tcpip 线程的上下文
+	/// 中进行：在 lwip 的回调中，或在 lwip::TcpIpCall 中。
+	class PbufChain
+	{
+	private:
+		pbuf *_head = nullptr;
+
+		/// @brief 自定义的释放函数。为空时直接 pbuf_free.
+		std::function<void(pbuf *)> _releaser;
+
+		/// @brief 第一个 pbuf 的接收时间戳。接管时读取，链表被拷贝过也不会丢失。
+		lwip::FrameTimestamp _timestamp{};
+
+	public:
+		PbufChain() = default;
+
+		/// @brief 接管一个 pbuf 链表。
+		/// @param head
+		/// @param releaser 自定义的释放函数。负责调用 pbuf_free.
+		PbufChain(pbuf *head, std::function<void(pbuf *)> releaser = nullptr);
+
+		/// @brief 接管一个 pbuf 链表，使用指定的接收时间戳。
+		/// @note 链表是接收到的 pbuf 的拷贝时使用，拷贝不带时间戳。
+		/// @param head
+		/// @param timestamp
+		/// @param releaser 自定义的释放函数。负责调用 pbuf_free.
+		PbufChain(pbuf *head, lwip::FrameTimestamp const &timestamp, std::function<void(pbuf *)> releaser);
+
+		PbufChain(PbufChain const &o) = delete;
+		PbufChain &operator=(PbufChain const &o) = delete;
+
+		PbufChain(PbufChain &&o);
+		PbufChain &operator=(PbufChain &&o);
+
+		~PbufChain();
+
+		/// @brief 获取链表头。
+		/// @return 已释放时返回空指针。
+		pbuf *Head() const
+		{
+			return _head;
+		}
+
+		/// @brief 数据的总字节数。
+		/// @return
+		int32_t Size() const;
+
+		/// @brief 获取链表中每个 pbuf 的数据的只读视图。
+		/// @note 视图在释放之前有效。
+		/// @return
+		std::vector<base::ReadOnlySpan> Spans() const;
+
+		/// @brief 获取第一个 pbuf 的接收时间戳。
+		/// @note 网卡开启了时间戳时才有。
+		/// @param timestamp
+		/// @return 没有时间戳返回 false.
+		bool TryGetTimestamp(lwip::FrameTimestamp &timestamp) const
+		{
+			if (!_timestamp.IsValid())
+			{
+				return false;
+			}
+
+			timestamp = _timestamp;
+			return true;
+		}
+
+		/// @brief 释放 pbuf 链表。
+		/// @note 本函数幂等。
+		void Release();
+	};
+} // namespace lwip
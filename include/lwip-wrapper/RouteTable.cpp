@@ -0,0 +1,201 @@
+#include "RouteTable.h"
+#include "base/string/define.h"
+#include "lwip/def.h"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+	uint32_t Mask(int32_t prefix_length)
+	{
+		if (prefix_length == 0)
+		{
+			return 0;
+		}
+
+		return 0xffffffffu << (32 - prefix_length);
+	}
+} // namespace
+
+void lwip::RouteTable::UpdateIndex()
+{
+	_group_begin.fill(0);
+	_group_end.fill(0);
+	_prefix_length_mask = 0;
+
+	for (size_t i = 0; i < _routes.size(); i++)
+	{
+		uint8_t prefix_length = _routes[i]._prefix_length;
+		if ((_prefix_length_mask & (1ull << prefix_length)) == 0)
+		{
+			_prefix_length_mask |= 1ull << prefix_length;
+			_group_begin[prefix_length] = static_cast<uint16_t>(i);
+		}
+
+		_group_end[prefix_length] = static_cast<uint16_t>(i + 1);
+	}
+}
+
+lwip::RouteTable::Route const *lwip::RouteTable::FindRoute(ip4_addr_t const *destination) const
+{
+	uint32_t host_order_destination = lwip_ntohl(ip4_addr_get_u32(destination));
+	uint64_t remaining = _prefix_length_mask;
+	while (remaining != 0)
+	{
+		// 从最长的前缀开始。
+		int32_t prefix_length = std::bit_width(remaining) - 1;
+		remaining &= ~(1ull << prefix_length);
+
+		uint32_t network = host_order_destination & Mask(prefix_length);
+		auto begin = _routes.begin() + _group_begin[prefix_length];
+		auto end = _routes.begin() + _group_end[prefix_length];
+		auto it = std::lower_bound(begin,
+								   end,
+								   network,
+								   [](Route const &route, uint32_t value)
+								   {
+									   return route._network < value;
+								   });
+
+		if (it == end || it->_network != network)
+		{
+			continue;
+		}
+
+		if (!netif_is_up(it->_netif) || !netif_is_link_up(it->_netif))
+		{
+			// 出口不可用，尝试更短的前缀。
+			continue;
+		}
+
+		return &*it;
+	}
+
+	return nullptr;
+}
+
+int32_t lwip::RouteTable::PrefixLength(ip4_addr_t const &netmask)
+{
+	uint32_t mask = lwip_ntohl(ip4_addr_get_u32(&netmask));
+	int32_t prefix_length = std::countl_one(mask);
+	if (Mask(prefix_length) != mask)
+	{
+		return -1;
+	}
+
+	return prefix_length;
+}
+
+void lwip::RouteTable::Add(ip4_addr_t const &network, int32_t prefix_length, ip4_addr_t const &gateway, netif *net_interface)
+{
+	if (prefix_length < 0 || prefix_length > 32)
+	{
+		throw std::invalid_argument{CODE_POS_STR + "前缀长度必须在 [0, 32] 内。"};
+	}
+
+	if (net_interface == nullptr)
+	{
+		throw std::invalid_argument{CODE_POS_STR + "禁止传入空指针。"};
+	}
+
+	Route route{};
+	route._network = lwip_ntohl(ip4_addr_get_u32(&network)) & Mask(prefix_length);
+	route._prefix_length = static_cast<uint8_t>(prefix_length);
+	route._gateway = gateway;
+	route._netif = net_interface;
+
+	auto it = std::lower_bound(_routes.begin(),
+							   _routes.end(),
+							   route,
+							   [](Route const &left, Route const &right)
+							   {
+								   if (left._prefix_length != right._prefix_length)
+								   {
+									   return left._prefix_length > right._prefix_length;
+								   }
+
+								   return left._network < right._network;
+							   });
+
+	if (it != _routes.end() &&
+		it->_prefix_length == route._prefix_length &&
+		it->_network == route._network)
+	{
+		*it = route;
+		return;
+	}
+
+	if (_routes.size() >= UINT16_MAX)
+	{
+		throw std::runtime_error{CODE_POS_STR + "路由表已满。"};
+	}
+
+	_routes.insert(it, route);
+	UpdateIndex();
+}
+
+bool lwip::RouteTable::Remove(ip4_addr_t const &network, int32_t prefix_length)
+{
+	if (prefix_length < 0 || prefix_length > 32)
+	{
+		return false;
+	}
+
+	uint32_t host_order_network = lwip_ntohl(ip4_addr_get_u32(&network)) & Mask(prefix_length);
+	auto it = std::find_if(_routes.begin(),
+						   _routes.end(),
+						   [&](Route const &route)
+						   {
+							   return route._prefix_length == prefix_length &&
+									  route._network == host_order_network;
+						   });
+
+	if (it == _routes.end())
+	{
+		return false;
+	}
+
+	_routes.erase(it);
+	UpdateIndex();
+	return true;
+}
+
+void lwip::RouteTable::RemoveAll(netif *net_interface)
+{
+	auto it = std::remove_if(_routes.begin(),
+							 _routes.end(),
+							 [&](Route const &route)
+							 {
+								 return route._netif == net_interface;
+							 });
+
+	_routes.erase(it, _routes.end());
+	UpdateIndex();
+}
+
+netif *lwip::RouteTable::FindNetif(ip4_addr_t const *destination) const
+{
+	Route const *route = FindRoute(destination);
+	if (route == nullptr)
+	{
+		return nullptr;
+	}
+
+	return route->_netif;
+}
+
+ip4_addr_t const *lwip::RouteTable::FindGateway(netif const *net_interface, ip4_addr_t const *destination) const
+{
+	Route const *route = FindRoute(destination);
+	if (route == nullptr || route->_netif != net_interface)
+	{
+		return nullptr;
+	}
+
+	if (ip4_addr_isany_val(route->_gateway))
+	{
+		return destination;
+	}
+
+	return &route->_gateway;
+}
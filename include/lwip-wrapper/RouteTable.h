@@ -0,0 +1,94 @@
+#pragma once
+#include "base/define.h"
+#include "lwip/netif.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace lwip
+{
+	/// @brief 最长前缀匹配的静态路由表。
+	/// @note 路由按前缀长度分组，每组内按网络地址排序。查找时只遍历存在路由的前缀长度，
+	/// 从长到短，每个前缀长度做一次二分查找。路由条数和网卡数增加时查找开销仍然很小。
+	///
+	/// @note 本类不加锁。查找在 tcpip 线程中进行，修改需要在 lwip 内核上下文中进行，
+	/// 由 NetifSlot 负责。
+	class RouteTable
+	{
+	private:
+		DELETE_COPY_AND_MOVE(RouteTable)
+
+		class Route
+		{
+		public:
+			/// @brief 网络地址，主机字节序。
+			uint32_t _network = 0;
+
+			uint8_t _prefix_length = 0;
+
+			/// @brief 下一跳网关。全 0 表示目的网络直接连在出口网卡上。
+			ip4_addr_t _gateway{};
+
+			/// @brief 出口网卡。
+			netif *_netif = nullptr;
+		};
+
+		/// @brief 按前缀长度从长到短，再按网络地址从小到大排列。
+		std::vector<Route> _routes;
+
+		/// @brief 前缀长度为 n 的路由在 _routes 中的范围是 [_group_begin[n], _group_end[n]).
+		std::array<uint16_t, 33> _group_begin{};
+		std::array<uint16_t, 33> _group_end{};
+
+		/// @brief 第 n 位为 1 表示存在前缀长度为 n 的路由。
+		uint64_t _prefix_length_mask = 0;
+
+		void UpdateIndex();
+
+		Route const *FindRoute(ip4_addr_t const *destination) const;
+
+	public:
+		RouteTable() = default;
+
+		/// @brief 将子网掩码转换为前缀长度。
+		/// @param netmask 子网掩码，网络字节序。
+		/// @return 子网掩码不连续返回 -1.
+		static int32_t PrefixLength(ip4_addr_t const &netmask);
+
+		/// @brief 添加一条路由。相同网络地址和前缀长度的路由已存在则替换。
+		/// @param network 网络地址，网络字节序。
+		/// @param prefix_length 前缀长度。
+		/// @param gateway 下一跳网关，网络字节序。全 0 表示直连。
+		/// @param net_interface 出口网卡。
+		void Add(ip4_addr_t const &network, int32_t prefix_length, ip4_addr_t const &gateway, netif *net_interface);
+
+		/// @brief 移除一条路由。
+		/// @param network 网络地址，网络字节序。
+		/// @param prefix_length 前缀长度。
+		/// @return 移除成功返回 true, 路由不存在返回 false.
+		bool Remove(ip4_addr_t const &network, int32_t prefix_length);
+
+		/// @brief 移除所有经过指定网卡的路由。
+		/// @param net_interface
+		void RemoveAll(netif *net_interface);
+
+		/// @brief 获取路由条数。
+		/// @return
+		int32_t Count() const
+		{
+			return static_cast<int32_t>(_routes.size());
+		}
+
+		/// @brief 查找到达目的地址的出口网卡。
+		/// @note 出口网卡没有启用或链路断开的路由会被跳过。
+		/// @param destination
+		/// @return 找不到返回空指针。
+		netif *FindNetif(ip4_addr_t const *destination) const;
+
+		/// @brief 查找经 net_interface 到达目的地址的下一跳。
+		/// @param net_interface
+		/// @param destination
+		/// @return 找不到匹配的路由返回空指针。直连路由返回 destination.
+		ip4_addr_t const *FindGateway(netif const *net_interface, ip4_addr_t const *destination) const;
+	};
+} // namespace lwip
@@ -0,0 +1,55 @@
+#pragma once
+#include "base/define.h"
+#include "lwip-wrapper/GracePeriod.h"
+#include <atomic>
+#include <memory>
+
+namespace lwip
+{
+	/// @brief 指向不可变快照的指针。读多写少时使用。
+	/// @note 读者无锁：进入读临界区只需要对计数器做一次原子加，读取指针，再做一次原子减。
+	/// 写者构造一个新的快照，原子地替换指针，然后等待宽限期结束，即所有可能还在读旧指针的
+	/// 读者都离开临界区，再释放旧快照的这一份引用。读者通过 Load 拿到的 shared_ptr 会让
+	/// 快照继续存活，直到读者用完。
+	///
+	/// @note 写者之间需要由调用者互斥。
+	template <typename T>
+	class SnapshotPointer
+	{
+	private:
+		DELETE_COPY_AND_MOVE(SnapshotPointer)
+
+		using holder_type = std::shared_ptr<T const>;
+
+		std::atomic<holder_type const *> _current{new holder_type{new T{}}};
+
+		/// @brief 保护 _current 指向的 holder 不在读者复制时被释放。
+		lwip::GracePeriod _grace_period;
+
+	public:
+		SnapshotPointer() = default;
+
+		~SnapshotPointer()
+		{
+			delete _current.load();
+		}
+
+		/// @brief 获取当前快照。
+		/// @return 不会返回空指针。
+		std::shared_ptr<T const> Load() const
+		{
+			lwip::GracePeriod::ReadGuard g{_grace_period};
+			return *_current.load();
+		}
+
+		/// @brief 发布新的快照。
+		/// @note 返回时已经没有读者在读旧的指针。
+		/// @param value 不能是空指针。
+		void Store(std::shared_ptr<T const> const &value)
+		{
+			holder_type const *old_holder = _current.exchange(new holder_type{value});
+			_grace_period.Synchronize();
+			delete old_holder;
+		}
+	};
+} // namespace lwip
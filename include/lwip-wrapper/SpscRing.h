@@ -0,0 +1,92 @@
+#pragma once
+#include "base/define.h"
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace lwip
+{
+	/// @brief 单生产者单消费者的无锁环形队列。
+	/// @note 生产者只写 _tail, 消费者只写 _head, 两者放在不同的缓存行中，互不干扰。
+	/// 每次 TryPush 和 TryPop 只有一次 release 写和一次 acquire 读。
+	///
+	/// @warning 同一时刻只能有一个线程调用 TryPush, 只能有一个线程调用 TryPop.
+	template <typename T>
+	class SpscRing
+	{
+	private:
+		DELETE_COPY_AND_MOVE(SpscRing)
+
+		static constexpr std::size_t CacheLineSize = 64;
+
+		std::vector<T> _slots;
+		uint32_t _mask = 0;
+
+		/// @brief 下一个要读取的位置。由消费者写。
+		alignas(CacheLineSize) std::atomic_uint32_t _head = 0;
+
+		/// @brief 下一个要写入的位置。由生产者写。
+		alignas(CacheLineSize) std::atomic_uint32_t _tail = 0;
+
+	public:
+		/// @brief 构造环形队列。
+		/// @param capacity 容量。必须是 2 的整数次幂。
+		SpscRing(uint32_t capacity)
+		{
+			if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+			{
+				throw std::invalid_argument{"容量必须是 2 的整数次幂。"};
+			}
+
+			_slots.resize(capacity);
+			_mask = capacity - 1;
+		}
+
+		/// @brief 放入一个元素。只能由生产者调用。
+		/// @param value
+		/// @return 队列满了返回 false, 此时 value 不会被移动。
+		bool TryPush(T &value)
+		{
+			uint32_t tail = _tail.load(std::memory_order_relaxed);
+			if (tail - _head.load(std::memory_order_acquire) > _mask)
+			{
+				return false;
+			}
+
+			_slots[tail & _mask] = std::move(value);
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// @brief 取出一个元素。只能由消费者调用。
+		/// @param value
+		/// @return 队列为空返回 false.
+		bool TryPop(T &value)
+		{
+			uint32_t head = _head.load(std::memory_order_relaxed);
+			if (head == _tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			value = std::move(_slots[head & _mask]);
+			_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// @brief 容量。
+		/// @return
+		uint32_t Capacity() const
+		{
+			return _mask + 1;
+		}
+
+		/// @brief 当前的元素个数。在生产者或消费者之外调用时只是一个近似值。
+		/// @return
+		uint32_t Count() const
+		{
+			return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+		}
+	};
+} // namespace lwip
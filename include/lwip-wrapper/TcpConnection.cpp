@@ -0,0 +1,446 @@
+#include "TcpConnection.h"
+#include "base/string/define.h"
+#include "InputPbuf.h"
+#include "lwip-wrapper/lwip_convert.h"
+#include <algorithm>
+
+void lwip::TcpConnection::Attach(tcp_pcb *pcb)
+{
+	_pcb = pcb;
+	_self = shared_from_this();
+
+	tcp_arg(_pcb, this);
+	tcp_recv(_pcb, ReceivingFunc);
+	tcp_sent(_pcb, SentFunc);
+	tcp_err(_pcb, ErrorFunc);
+
+	// 每秒轮询一次，重试因为内存不足而失败的发送和关闭。
+	tcp_poll(_pcb, PollFunc, 2);
+}
+
+void lwip::TcpConnection::Detach()
+{
+	if (_pcb != nullptr)
+	{
+		tcp_arg(_pcb, nullptr);
+		tcp_recv(_pcb, nullptr);
+		tcp_sent(_pcb, nullptr);
+		tcp_err(_pcb, nullptr);
+		tcp_poll(_pcb, nullptr, 0);
+		_pcb = nullptr;
+	}
+
+	_connected = false;
+
+	// 最后释放自身的引用，之后本对象可能已经析构。
+	std::shared_ptr<TcpConnection> self = std::move(_self);
+}
+
+void lwip::TcpConnection::TrySend()
+{
+	if (_pcb == nullptr || !_connected)
+	{
+		return;
+	}
+
+	bool queued_any = false;
+	for (PendingWrite &pending_write : _pending_writes)
+	{
+		while (pending_write._queued_size < pending_write._span.Size())
+		{
+			int32_t remaining = pending_write._span.Size() - pending_write._queued_size;
+			int32_t size = std::min<int32_t>({remaining, tcp_sndbuf(_pcb), UINT16_MAX});
+			if (size <= 0 || tcp_sndqueuelen(_pcb) >= TCP_SND_QUEUELEN)
+			{
+				// 发送缓冲区满了，等对方确认后在 SentFunc 中继续。
+				break;
+			}
+
+			// 不带 TCP_WRITE_FLAG_COPY, lwip 直接引用应用的缓冲区。
+			err_t result = tcp_write(_pcb,
+									 pending_write._span.Buffer() + pending_write._queued_size,
+									 static_cast<u16_t>(size),
+									 0);
+
+			if (result != err_enum_t::ERR_OK)
+			{
+				break;
+			}
+
+			pending_write._queued_size += size;
+			queued_any = true;
+		}
+
+		if (pending_write._queued_size < pending_write._span.Size())
+		{
+			break;
+		}
+	}
+
+	if (queued_any)
+	{
+		tcp_output(_pcb);
+	}
+}
+
+void lwip::TcpConnection::TryClose()
+{
+	if (!_close_requested || _pcb == nullptr || !_pending_writes.empty())
+	{
+		return;
+	}
+
+	tcp_pcb *pcb = _pcb;
+	tcp_arg(pcb, nullptr);
+	tcp_recv(pcb, nullptr);
+	tcp_sent(pcb, nullptr);
+	tcp_err(pcb, nullptr);
+	tcp_poll(pcb, nullptr, 0);
+
+	if (tcp_close(pcb) != err_enum_t::ERR_OK)
+	{
+		// 内存不足，恢复回调，在 PollFunc 中重试。
+		tcp_arg(pcb, this);
+		tcp_recv(pcb, ReceivingFunc);
+		tcp_sent(pcb, SentFunc);
+		tcp_err(pcb, ErrorFunc);
+		tcp_poll(pcb, PollFunc, 2);
+		return;
+	}
+
+	_pcb = nullptr;
+	Detach();
+}
+
+void lwip::TcpConnection::FailPendingWrites()
+{
+	std::deque<PendingWrite> pending_writes = std::move(_pending_writes);
+	_pending_writes.clear();
+	for (PendingWrite &pending_write : pending_writes)
+	{
+		if (pending_write._completion_callback != nullptr)
+		{
+			pending_write._completion_callback(false);
+		}
+	}
+}
+
+void lwip::TcpConnection::OnClosed()
+{
+	if (_closed_callback != nullptr)
+	{
+		_closed_callback();
+	}
+}
+
+void lwip::TcpConnection::EnterCallback(tcp_pcb *pcb)
+{
+	_callback_pcb = pcb;
+	_aborted_in_callback = false;
+}
+
+err_t lwip::TcpConnection::LeaveCallback()
+{
+	_callback_pcb = nullptr;
+	if (_aborted_in_callback)
+	{
+		_aborted_in_callback = false;
+		return err_enum_t::ERR_ABRT;
+	}
+
+	return err_enum_t::ERR_OK;
+}
+
+#pragma region lwip 回调
+
+err_t lwip::TcpConnection::ConnectedFunc(void *arg, tcp_pcb *pcb, err_t err)
+{
+	TcpConnection *self = reinterpret_cast<TcpConnection *>(arg);
+	if (self == nullptr)
+	{
+		return err_enum_t::ERR_OK;
+	}
+
+	// 防止应用的回调中释放最后一个引用。
+	std::shared_ptr<TcpConnection> keep_alive = self->_self;
+	self->EnterCallback(pcb);
+
+	// lwip 目前总是以 ERR_OK 调用本回调，失败通过 ErrorFunc 通知。
+	self->_connected = err == err_enum_t::ERR_OK;
+	if (self->_connected_callback != nullptr)
+	{
+		std::function<void(bool)> callback = std::move(self->_connected_callback);
+		self->_connected_callback = nullptr;
+		callback(self->_connected);
+	}
+
+	if (self->_pcb != nullptr)
+	{
+		self->TrySend();
+	}
+
+	return self->LeaveCallback();
+}
+
+err_t lwip::TcpConnection::ReceivingFunc(void *arg, tcp_pcb *pcb, pbuf *p, err_t err)
+{
+	TcpConnection *self = reinterpret_cast<TcpConnection *>(arg);
+	if (self == nullptr)
+	{
+		if (p != nullptr)
+		{
+			tcp_recved(pcb, p->tot_len);
+			pbuf_free(p);
+		}
+
+		return err_enum_t::ERR_OK;
+	}
+
+	std::shared_ptr<TcpConnection> keep_alive = self->_self;
+	if (p == nullptr)
+	{
+		// 对方关闭了发送方向。
+		self->EnterCallback(pcb);
+		self->OnClosed();
+		return self->LeaveCallback();
+	}
+
+	if (err != err_enum_t::ERR_OK || self->_receiving_callback == nullptr)
+	{
+		// 拒绝接收，lwip 会暂存数据，稍后重新调用本回调。
+		return err_enum_t::ERR_MEM;
+	}
+
+	// 拷贝前读取，拷贝得到的 pbuf 不再带有时间戳。
+	lwip::FrameTimestamp timestamp{};
+	lwip::TryGetFrameTimestamp(p, timestamp);
+
+	if (lwip::InputPbuf::ReferencesFrame(p))
+	{
+		/* 引用以太网端口内存的 pbuf 先拷贝，应用持有 PbufChain 多久都不影响网卡释放。
+		 * 内存不够时拒绝接收，lwip 会暂存数据，稍后重新调用本回调。
+		 */
+		pbuf *copy = pbuf_clone(pbuf_layer::PBUF_RAW, pbuf_type::PBUF_RAM, p);
+		if (copy == nullptr)
+		{
+			return err_enum_t::ERR_MEM;
+		}
+
+		pbuf_free(p);
+		p = copy;
+	}
+
+	std::weak_ptr<TcpConnection> weak_self = self->_self;
+	lwip::PbufChain chain{
+		p,
+		timestamp,
+		[weak_self](pbuf *head)
+		{
+			std::shared_ptr<TcpConnection> connection = weak_self.lock();
+			if (connection != nullptr && connection->_pcb != nullptr)
+			{
+				// 应用用完了数据，打开接收窗口。
+				tcp_recved(connection->_pcb, head->tot_len);
+			}
+
+			pbuf_free(head);
+		},
+	};
+
+	// 返回 ERR_ABRT 时 lwip 同样不再管理 p, 由 chain 释放。
+	self->EnterCallback(pcb);
+	self->_receiving_callback(std::move(chain));
+	return self->LeaveCallback();
+}
+
+err_t lwip::TcpConnection::SentFunc(void *arg, tcp_pcb *pcb, u16_t len)
+{
+	TcpConnection *self = reinterpret_cast<TcpConnection *>(arg);
+	if (self == nullptr)
+	{
+		return err_enum_t::ERR_OK;
+	}
+
+	// 防止完成回调中释放最后一个引用。
+	std::shared_ptr<TcpConnection> keep_alive = self->_self;
+	self->EnterCallback(pcb);
+
+	int32_t acknowledged = len;
+	while (acknowledged > 0 && !self->_pending_writes.empty())
+	{
+		PendingWrite &pending_write = self->_pending_writes.front();
+		int32_t size = std::min(acknowledged, pending_write._queued_size - pending_write._acknowledged_size);
+		pending_write._acknowledged_size += size;
+		acknowledged -= size;
+		if (pending_write._acknowledged_size < pending_write._span.Size())
+		{
+			break;
+		}
+
+		std::function<void(bool)> callback = std::move(pending_write._completion_callback);
+		self->_pending_writes.pop_front();
+		if (callback != nullptr)
+		{
+			callback(true);
+		}
+	}
+
+	self->TrySend();
+	self->TryClose();
+	return self->LeaveCallback();
+}
+
+err_t lwip::TcpConnection::PollFunc(void *arg, tcp_pcb *pcb)
+{
+	TcpConnection *self = reinterpret_cast<TcpConnection *>(arg);
+	if (self == nullptr)
+	{
+		return err_enum_t::ERR_OK;
+	}
+
+	std::shared_ptr<TcpConnection> keep_alive = self->_self;
+	self->EnterCallback(pcb);
+	self->TrySend();
+	self->TryClose();
+	return self->LeaveCallback();
+}
+
+void lwip::TcpConnection::ErrorFunc(void *arg, err_t err)
+{
+	(void)err;
+	TcpConnection *self = reinterpret_cast<TcpConnection *>(arg);
+	if (self == nullptr)
+	{
+		return;
+	}
+
+	std::shared_ptr<TcpConnection> keep_alive = self->_self;
+
+	// lwip 调用本回调时已经释放了 pcb, 包括引用着应用缓冲区的报文段。
+	self->_pcb = nullptr;
+	if (self->_connected_callback != nullptr)
+	{
+		std::function<void(bool)> callback = std::move(self->_connected_callback);
+		self->_connected_callback = nullptr;
+		callback(false);
+	}
+
+	self->FailPendingWrites();
+	self->OnClosed();
+	self->Detach();
+}
+
+#pragma endregion
+
+lwip::TcpConnection::~TcpConnection()
+{
+	/* 连接期间 _self 持有本对象，能析构说明已经 Detach 或从未连接。这里只处理
+	 * 创建了 pcb 但 Attach 失败的情况。
+	 */
+	if (_pcb != nullptr)
+	{
+		tcp_arg(_pcb, nullptr);
+		tcp_abort(_pcb);
+		_pcb = nullptr;
+	}
+}
+
+void lwip::TcpConnection::SetReceivingCallback(std::function<void(lwip::PbufChain)> callback)
+{
+	_receiving_callback = std::move(callback);
+}
+
+void lwip::TcpConnection::SetClosedCallback(std::function<void()> callback)
+{
+	_closed_callback = std::move(callback);
+}
+
+void lwip::TcpConnection::Connect(base::IPAddress const &ip_address,
+								  uint16_t port,
+								  std::function<void(bool)> connected_callback)
+{
+	if (_pcb != nullptr)
+	{
+		throw std::runtime_error{std::string{CODE_POS_STR} + "已经连接或正在连接。"};
+	}
+
+	tcp_pcb *pcb = tcp_new();
+	if (pcb == nullptr)
+	{
+		throw std::runtime_error{std::string{CODE_POS_STR} + "创建 tcp_pcb 失败。"};
+	}
+
+	_connected_callback = std::move(connected_callback);
+	_close_requested = false;
+	Attach(pcb);
+
+	ip_addr_t remote_address{};
+	remote_address << ip_address;
+
+	err_t result = tcp_connect(_pcb, &remote_address, port, ConnectedFunc);
+	if (result != err_enum_t::ERR_OK)
+	{
+		tcp_pcb *failed_pcb = _pcb;
+		_connected_callback = nullptr;
+		Detach();
+		tcp_abort(failed_pcb);
+		throw std::runtime_error{std::string{CODE_POS_STR} + "tcp_connect 失败。"};
+	}
+}
+
+void lwip::TcpConnection::Write(base::ReadOnlySpan const &span, std::function<void(bool)> completion_callback)
+{
+	if (_pcb == nullptr || _close_requested)
+	{
+		throw std::runtime_error{std::string{CODE_POS_STR} + "连接已关闭。"};
+	}
+
+	if (span.Size() == 0)
+	{
+		if (completion_callback != nullptr)
+		{
+			completion_callback(true);
+		}
+
+		return;
+	}
+
+	PendingWrite pending_write{};
+	pending_write._span = span;
+	pending_write._completion_callback = std::move(completion_callback);
+	_pending_writes.push_back(std::move(pending_write));
+	TrySend();
+}
+
+void lwip::TcpConnection::Close()
+{
+	if (_pcb == nullptr)
+	{
+		return;
+	}
+
+	_close_requested = true;
+	TryClose();
+}
+
+void lwip::TcpConnection::Abort()
+{
+	if (_pcb == nullptr)
+	{
+		return;
+	}
+
+	std::shared_ptr<TcpConnection> keep_alive = _self;
+	tcp_pcb *pcb = _pcb;
+	if (pcb == _callback_pcb)
+	{
+		// 在本连接的回调中终止，回调需要返回 ERR_ABRT.
+		_aborted_in_callback = true;
+	}
+
+	Detach();
+
+	// tcp_abort 会同步释放报文段，之后 lwip 不再引用应用的缓冲区。
+	tcp_abort(pcb);
+	FailPendingWrites();
+}
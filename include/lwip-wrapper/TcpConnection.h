@@ -0,0 +1,140 @@
+#pragma once
+#include "base/net/IPAddress.h"
+#include "lwip-wrapper/PbufChain.h"
+#include "lwip/tcp.h"
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace lwip
+{
+	class TcpListener;
+
+	/// @brief 基于 lwip raw API 的 TCP 连接。
+	/// @note 与 socket 相比，接收到的数据以 pbuf 链表的形式直接交给应用，发送时 lwip 直接引用
+	/// 应用的缓冲区，都不拷贝，也不经过 tcpip 线程的邮箱。只有引用着以太网端口内存的接收
+	/// pbuf 会先拷贝一次，应用持有 PbufChain 多久都不影响网卡释放。
+	///
+	/// @warning 本类的所有方法都必须在 tcpip 线程的上下文中调用：在本类的回调中，或在
+	/// lwip::TcpIpCall 中。回调都在 tcpip 线程中执行，禁止阻塞。
+	///
+	/// @note 本对象必须由 std::shared_ptr 持有。连接建立后，连接会持有自身的引用，直到连接
+	/// 关闭或出错，所以应用丢弃引用不会关闭连接，需要调用 Close 或 Abort.
+	class TcpConnection :
+		public std::enable_shared_from_this<TcpConnection>
+	{
+	private:
+		friend class lwip::TcpListener;
+
+		/// @brief 等待对方确认的写入。
+		class PendingWrite
+		{
+		public:
+			base::ReadOnlySpan _span;
+
+			/// @brief 已经交给 tcp_write 的字节数。
+			int32_t _queued_size = 0;
+
+			/// @brief 已经被对方确认的字节数。
+			int32_t _acknowledged_size = 0;
+
+			std::function<void(bool)> _completion_callback;
+		};
+
+		tcp_pcb *_pcb = nullptr;
+		bool _connected = false;
+		bool _close_requested = false;
+
+		/// @brief 正在执行回调的 pcb. 不在回调中时为空。
+		tcp_pcb *_callback_pcb = nullptr;
+
+		/// @brief 应用在 _callback_pcb 的回调中调用了 Abort.
+		/// @note 这时 pcb 已经被 tcp_abort 释放，回调必须返回 ERR_ABRT, 否则 lwip 会继续
+		/// 访问它。
+		bool _aborted_in_callback = false;
+
+		/// @brief 连接期间持有自身的引用，防止 lwip 回调时本对象已经析构。
+		std::shared_ptr<TcpConnection> _self;
+
+		std::deque<PendingWrite> _pending_writes;
+
+		std::function<void(bool)> _connected_callback;
+		std::function<void(lwip::PbufChain)> _receiving_callback;
+		std::function<void()> _closed_callback;
+
+		/// @brief 接管 _pcb, 注册回调。
+		void Attach(tcp_pcb *pcb);
+
+		/// @brief 注销回调，放弃 _pcb.
+		/// @note 可能会释放最后一个引用，调用后禁止再访问本对象。
+		void Detach();
+
+		/// @brief 把还没有交给 tcp_write 的数据尽量交给它。
+		void TrySend();
+
+		/// @brief 所有写入都被确认后，执行被推迟的关闭。
+		void TryClose();
+
+		/// @brief 所有未完成的写入都以失败结束。
+		void FailPendingWrites();
+
+		void OnClosed();
+
+		/// @brief lwip 回调 pcb 时，在调用应用的回调之前调用。
+		/// @param pcb
+		void EnterCallback(tcp_pcb *pcb);
+
+		/// @brief 离开 EnterCallback 开始的回调。
+		/// @return 回调期间应用调用了 Abort 时返回 ERR_ABRT, 否则返回 ERR_OK. 作为 lwip
+		/// 回调的返回值。
+		err_t LeaveCallback();
+
+		static err_t ConnectedFunc(void *arg, tcp_pcb *pcb, err_t err);
+		static err_t ReceivingFunc(void *arg, tcp_pcb *pcb, pbuf *p, err_t err);
+		static err_t SentFunc(void *arg, tcp_pcb *pcb, u16_t len);
+		static err_t PollFunc(void *arg, tcp_pcb *pcb);
+		static void ErrorFunc(void *arg, err_t err);
+
+	public:
+		TcpConnection() = default;
+		~TcpConnection();
+
+		/// @brief 设置接收到数据时的回调。
+		/// @note 应用用完数据后调用 PbufChain::Release 释放，释放后接收窗口才会打开。
+		/// 在设置回调之前到达的数据由 lwip 暂存。
+		/// @param callback
+		void SetReceivingCallback(std::function<void(lwip::PbufChain)> callback);
+
+		/// @brief 设置连接被对方关闭，或出错时的回调。
+		/// @param callback
+		void SetClosedCallback(std::function<void()> callback);
+
+		/// @brief 连接到服务器。
+		/// @param ip_address
+		/// @param port
+		/// @param connected_callback 连接成功时以 true 调用，失败时以 false 调用。
+		void Connect(base::IPAddress const &ip_address, uint16_t port, std::function<void(bool)> connected_callback);
+
+		/// @brief 检查连接是否已经建立。
+		/// @return
+		bool IsConnected() const
+		{
+			return _connected;
+		}
+
+		/// @brief 发送应用的缓冲区，不拷贝。
+		/// @note 缓冲区在完成回调被调用之前必须保持有效且不被修改。发送缓冲区满时，数据排队
+		/// 等待，对方确认了之前的数据后再交给 lwip.
+		/// @param span 要发送的数据。
+		/// @param completion_callback 数据全部被对方确认后以 true 调用，连接关闭或出错导致
+		/// 发送失败时以 false 调用。可以为空。
+		void Write(base::ReadOnlySpan const &span, std::function<void(bool)> completion_callback);
+
+		/// @brief 优雅地关闭连接。
+		/// @note 会等到所有写入都被确认后再关闭，以免 lwip 还引用着应用的缓冲区。
+		void Close();
+
+		/// @brief 发送 RST 立刻终止连接。未完成的写入以失败结束。
+		void Abort();
+	};
+} // namespace lwip
@@ -0,0 +1,50 @@
+#include "TcpIpCall.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/tcpip.h"
+#include <exception>
+
+namespace
+{
+	/// @brief tcpip_api_call 的参数。tcpip_api_call_data 必须是第一个字段。
+	class CallData
+	{
+	public:
+		tcpip_api_call_data _base;
+		void (*_func)(void *);
+		void *_arg;
+		std::exception_ptr *_exception;
+	};
+
+	/// @brief 在内核上下文中执行。异常不能穿过 lwip 的 C 代码，捕获后交给调用线程。
+	/// @param data
+	/// @return
+	err_t CallFunc(tcpip_api_call_data *data)
+	{
+		CallData *call_data = reinterpret_cast<CallData *>(data);
+		try
+		{
+			call_data->_func(call_data->_arg);
+		}
+		catch (...)
+		{
+			*call_data->_exception = std::current_exception();
+		}
+
+		return err_enum_t::ERR_OK;
+	}
+} // namespace
+
+void lwip::TcpIpCall(void (*func)(void *), void *arg)
+{
+	std::exception_ptr exception{};
+	CallData call_data{};
+	call_data._func = func;
+	call_data._arg = arg;
+	call_data._exception = &exception;
+	tcpip_api_call(CallFunc, &call_data._base);
+
+	if (exception != nullptr)
+	{
+		std::rethrow_exception(exception);
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <type_traits>
+
+namespace lwip
+{
+	/// @brief 在 lwip 的内核上下文中执行 func(arg), 返回后 func 已经执行完。
+	/// @note 开启了 LWIP_TCPIP_CORE_LOCKING 时在调用线程中持有内核锁执行，否则投递到 tcpip
+	/// 线程执行并等待。func 抛出的异常会在调用线程中重新抛出。
+	/// @warning 禁止在 tcpip 线程中，以及已经持有内核锁时调用。
+	/// @param func
+	/// @param arg
+	void TcpIpCall(void (*func)(void *), void *arg);
+
+	/// @brief 在 lwip 的内核上下文中执行 func, 让 tcpip 线程以外的线程可以安全地调用 lwip 的
+	/// raw API.
+	/// @note 不经过 std::function, 快速路径上调用不会分配内存。
+	/// @warning 禁止在 tcpip 线程中，以及已经持有内核锁时调用。
+	/// @param func
+	template <typename FuncType>
+	void TcpIpCall(FuncType &&func)
+	{
+		lwip::TcpIpCall(
+			[](void *arg)
+			{
+				(*static_cast<std::remove_reference_t<FuncType> *>(arg))();
+			},
+			&func);
+	}
+} // namespace lwip
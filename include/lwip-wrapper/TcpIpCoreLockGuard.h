@@ -0,0 +1,35 @@
+#pragma once
+#include "base/define.h"
+#include "lwip/opt.h"
+#include "lwip/tcpip.h"
+
+/* 本库自身用 lwip::TcpIpCall 进入内核上下文，不依赖内核锁。本类只在开启了
+ * LWIP_TCPIP_CORE_LOCKING 时提供，供确定开启了内核锁的应用使用。
+ */
+#if LWIP_TCPIP_CORE_LOCKING
+
+namespace lwip
+{
+	/// @brief 在作用域内持有 lwip 的内核锁，让 tcpip 线程以外的线程可以安全地调用 lwip 的
+	/// raw API.
+	/// @note 不确定是否开启内核锁的代码请用 lwip::TcpIpCall.
+	/// @warning 内核锁不可重入。禁止在 tcpip 线程中，以及已经持有内核锁时使用。
+	class TcpIpCoreLockGuard
+	{
+	private:
+		DELETE_COPY_AND_MOVE(TcpIpCoreLockGuard)
+
+	public:
+		TcpIpCoreLockGuard()
+		{
+			LOCK_TCPIP_CORE();
+		}
+
+		~TcpIpCoreLockGuard()
+		{
+			UNLOCK_TCPIP_CORE();
+		}
+	};
+} // namespace lwip
+
+#endif
@@ -0,0 +1,86 @@
+#include "TcpListener.h"
+#include "base/string/define.h"
+#include "lwip-wrapper/lwip_convert.h"
+
+err_t lwip::TcpListener::AcceptedFunc(void *arg, tcp_pcb *newpcb, err_t err)
+{
+	TcpListener *self = reinterpret_cast<TcpListener *>(arg);
+	if (newpcb == nullptr || err != err_enum_t::ERR_OK)
+	{
+		return err_enum_t::ERR_VAL;
+	}
+
+	if (self == nullptr || self->_accepted_callback == nullptr)
+	{
+		tcp_abort(newpcb);
+		return err_enum_t::ERR_ABRT;
+	}
+
+	std::shared_ptr<lwip::TcpConnection> connection{new lwip::TcpConnection{}};
+	connection->Attach(newpcb);
+	connection->_connected = true;
+
+	// 应用可能在回调中终止新连接，这时必须返回 ERR_ABRT.
+	connection->EnterCallback(newpcb);
+	self->_accepted_callback(connection);
+	return connection->LeaveCallback();
+}
+
+lwip::TcpListener::~TcpListener()
+{
+	Stop();
+}
+
+void lwip::TcpListener::Listen(base::IPAddress const &ip_address,
+							   uint16_t port,
+							   uint8_t backlog,
+							   std::function<void(std::shared_ptr<lwip::TcpConnection>)> accepted_callback)
+{
+	if (_pcb != nullptr)
+	{
+		throw std::runtime_error{std::string{CODE_POS_STR} + "已经在监听。"};
+	}
+
+	tcp_pcb *pcb = tcp_new();
+	if (pcb == nullptr)
+	{
+		throw std::runtime_error{std::string{CODE_POS_STR} + "创建 tcp_pcb 失败。"};
+	}
+
+	ip_addr_t local_address{};
+	local_address << ip_address;
+	if (tcp_bind(pcb, &local_address, port) != err_enum_t::ERR_OK)
+	{
+		tcp_close(pcb);
+		throw std::runtime_error{std::string{CODE_POS_STR} + "tcp_bind 失败。"};
+	}
+
+	// 成功时 lwip 释放 pcb, 返回一个更小的监听用的 pcb.
+	tcp_pcb *listening_pcb = tcp_listen_with_backlog(pcb, backlog);
+	if (listening_pcb == nullptr)
+	{
+		tcp_close(pcb);
+		throw std::runtime_error{std::string{CODE_POS_STR} + "tcp_listen 失败。"};
+	}
+
+	_pcb = listening_pcb;
+	_accepted_callback = std::move(accepted_callback);
+	tcp_arg(_pcb, this);
+	tcp_accept(_pcb, AcceptedFunc);
+}
+
+void lwip::TcpListener::Stop()
+{
+	if (_pcb == nullptr)
+	{
+		return;
+	}
+
+	tcp_arg(_pcb, nullptr);
+	tcp_accept(_pcb, nullptr);
+
+	// 监听的 pcb 关闭不会失败。
+	tcp_close(_pcb);
+	_pcb = nullptr;
+	_accepted_callback = nullptr;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "base/define.h"
+#include "base/net/IPAddress.h"
+#include "lwip-wrapper/TcpConnection.h"
+#include "lwip/tcp.h"
+#include <functional>
+#include <memory>
+
+namespace lwip
+{
+	/// @brief 基于 lwip raw API 的 TCP 监听器。
+	/// @warning 与 lwip::TcpConnection 一样，所有方法都必须在 tcpip 线程的上下文中调用。
+	class TcpListener
+	{
+	private:
+		tcp_pcb *_pcb = nullptr;
+		std::function<void(std::shared_ptr<lwip::TcpConnection>)> _accepted_callback;
+
+		static err_t AcceptedFunc(void *arg, tcp_pcb *newpcb, err_t err);
+
+	public:
+		TcpListener() = default;
+		~TcpListener();
+
+		DELETE_COPY_AND_MOVE(TcpListener)
+
+		/// @brief 开始监听。
+		/// @param ip_address 要绑定的地址。传入 0.0.0.0 表示所有网卡。
+		/// @param port
+		/// @param backlog 还没有被接受的连接的最大数量。
+		/// @param accepted_callback 接受了新连接时被调用。应用需要在回调中设置连接的接收回调。
+		void Listen(base::IPAddress const &ip_address,
+					uint16_t port,
+					uint8_t backlog,
+					std::function<void(std::shared_ptr<lwip::TcpConnection>)> accepted_callback);
+
+		/// @brief 停止监听。已经接受的连接不受影响。
+		void Stop();
+	};
+} // namespace lwip
@@ -0,0 +1,25 @@
+#pragma once
+#include "base/net/IPAddress.h"
+#include "lwip-wrapper/FrameTimestamp.h"
+#include <cstdint>
+
+namespace lwip
+{
+	/// @brief UDP 数据报。
+	/// @note 只引用负载，不持有。发送时表示目的地，接收时表示来源。
+	class UdpDatagram
+	{
+	public:
+		/// @brief 对方的 IP 地址。
+		base::IPAddress _remote_ip_address;
+
+		/// @brief 对方的端口。
+		uint16_t _remote_port = 0;
+
+		/// @brief 负载。
+		base::ReadOnlySpan _payload;
+
+		/// @brief 接收时间戳。只在接收时，且网卡开启了时间戳时有效。
+		lwip::FrameTimestamp _timestamp{};
+	};
+} // namespace lwip
@@ -0,0 +1,336 @@
+#include "UdpEndpoint.h"
+#include "base/string/define.h"
+#include "InputPbuf.h"
+#include "lwip-wrapper/lwip_convert.h"
+#include "lwip-wrapper/TcpIpCall.h"
+#include <cstring>
+
+namespace
+{
+	/// @brief 在作用域内持有消费者锁。
+	class ReceivingLockGuard
+	{
+	private:
+		base::task::BinarySemaphore &_lock;
+
+	public:
+		ReceivingLockGuard(base::task::BinarySemaphore &lock)
+			: _lock(lock)
+		{
+			_lock.Acquire();
+		}
+
+		~ReceivingLockGuard()
+		{
+			_lock.Release();
+		}
+	};
+} // namespace
+
+pbuf *lwip::UdpEndpoint::TakeSendingPbuf(uint16_t size, bool &pooled)
+{
+	pooled = false;
+	if (size <= _sending_pbuf_size)
+	{
+		for (std::size_t i = 0; i < _sending_pbuf_pool.size(); i++)
+		{
+			PooledPbuf &pooled_pbuf = _sending_pbuf_pool[_next_sending_pbuf_index];
+			_next_sending_pbuf_index = (_next_sending_pbuf_index + 1) % _sending_pbuf_pool.size();
+
+			// 引用计数大于 1 说明还被 lwip 持有，例如在 ARP 队列中等待解析。
+			if (pooled_pbuf._pbuf->ref != 1)
+			{
+				continue;
+			}
+
+			// 恢复被 lwip 添加首部时移动过的负载指针。
+			pooled_pbuf._pbuf->payload = pooled_pbuf._payload;
+			pooled_pbuf._pbuf->len = size;
+			pooled_pbuf._pbuf->tot_len = size;
+			pooled = true;
+			return pooled_pbuf._pbuf;
+		}
+	}
+
+	return pbuf_alloc(pbuf_layer::PBUF_TRANSPORT, size, pbuf_type::PBUF_RAM);
+}
+
+void lwip::UdpEndpoint::FreeReceivingBatch()
+{
+	for (ReceivedDatagram &datagram : _receiving_batch)
+	{
+		pbuf_free(datagram._pbuf);
+	}
+
+	_receiving_batch.clear();
+}
+
+void lwip::UdpEndpoint::ReceivingFunc(void *arg, udp_pcb *pcb, pbuf *p, ip_addr_t const *addr, u16_t port)
+{
+	(void)pcb;
+	UdpEndpoint *self = reinterpret_cast<UdpEndpoint *>(arg);
+
+	// 拼接前读取，拼接得到的 pbuf 不再带有时间戳。
+	ReceivedDatagram received_datagram{};
+	lwip::TryGetFrameTimestamp(p, received_datagram._timestamp);
+
+	/* 分片重组得到的链表，拼成一个 pbuf, 应用就能以一个连续的视图访问负载。
+	 * 引用以太网端口内存的 pbuf 也拷贝，应用持有数据报多久都不影响网卡释放。
+	 */
+	if (p->next != nullptr || lwip::InputPbuf::ReferencesFrame(p))
+	{
+		pbuf *flat = pbuf_clone(pbuf_layer::PBUF_RAW, pbuf_type::PBUF_RAM, p);
+		pbuf_free(p);
+		if (flat == nullptr)
+		{
+			self->_dropped_datagram_count++;
+			return;
+		}
+
+		p = flat;
+	}
+
+	received_datagram._pbuf = p;
+	received_datagram._remote_ip_address << *addr;
+	received_datagram._remote_port = port;
+	if (!self->_receiving_ring.TryPush(received_datagram))
+	{
+		pbuf_free(p);
+		self->_dropped_datagram_count++;
+		return;
+	}
+
+	self->_received_datagram_count++;
+}
+
+lwip::UdpEndpoint::UdpEndpoint(uint32_t receiving_ring_capacity,
+							   int32_t sending_pbuf_count,
+							   uint16_t sending_pbuf_size)
+	: _sending_pbuf_size(sending_pbuf_size),
+	  _receiving_ring(receiving_ring_capacity)
+{
+	_receiving_batch.reserve(receiving_ring_capacity);
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			for (int32_t i = 0; i < sending_pbuf_count; i++)
+			{
+				pbuf *p = pbuf_alloc(pbuf_layer::PBUF_TRANSPORT, sending_pbuf_size, pbuf_type::PBUF_RAM);
+				if (p == nullptr)
+				{
+					// 内存不够就少预分配一些，不够用时 TakeSendingPbuf 会临时分配。
+					break;
+				}
+
+				PooledPbuf pooled_pbuf{};
+				pooled_pbuf._pbuf = p;
+				pooled_pbuf._payload = p->payload;
+				_sending_pbuf_pool.push_back(pooled_pbuf);
+			}
+		});
+}
+
+lwip::UdpEndpoint::~UdpEndpoint()
+{
+	Close();
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			for (PooledPbuf &pooled_pbuf : _sending_pbuf_pool)
+			{
+				pbuf_free(pooled_pbuf._pbuf);
+			}
+
+			_sending_pbuf_pool.clear();
+		});
+}
+
+void lwip::UdpEndpoint::Bind(base::IPAddress const &ip_address, uint16_t port)
+{
+	lwip::TcpIpCall(
+		[&]()
+		{
+			if (_pcb != nullptr)
+			{
+				throw std::runtime_error{std::string{CODE_POS_STR} + "已经绑定。"};
+			}
+
+			udp_pcb *pcb = udp_new();
+			if (pcb == nullptr)
+			{
+				throw std::runtime_error{std::string{CODE_POS_STR} + "创建 udp_pcb 失败。"};
+			}
+
+			ip_addr_t local_address{};
+			local_address << ip_address;
+			if (udp_bind(pcb, &local_address, port) != err_enum_t::ERR_OK)
+			{
+				udp_remove(pcb);
+				throw std::runtime_error{std::string{CODE_POS_STR} + "udp_bind 失败。"};
+			}
+
+			udp_recv(pcb, ReceivingFunc, this);
+			_pcb = pcb;
+		});
+}
+
+void lwip::UdpEndpoint::Close()
+{
+	lwip::TcpIpCall(
+		[&]()
+		{
+			if (_pcb != nullptr)
+			{
+				udp_remove(_pcb);
+				_pcb = nullptr;
+			}
+		});
+
+	// 已经没有生产者了。持有消费者锁，等正在执行的 ReceiveBatch 返回后再取出剩下的数据报。
+	ReceivingLockGuard g{_receiving_lock};
+	ReceivedDatagram received_datagram{};
+	while (_receiving_ring.TryPop(received_datagram))
+	{
+		_receiving_batch.push_back(received_datagram);
+	}
+
+	if (_receiving_batch.empty())
+	{
+		return;
+	}
+
+	lwip::TcpIpCall(
+		[&]()
+		{
+			FreeReceivingBatch();
+		});
+}
+
+int32_t lwip::UdpEndpoint::SendBatch(std::vector<lwip::UdpDatagram> const &datagrams)
+{
+	int32_t sent_count = 0;
+	int32_t reused_count = 0;
+
+	// 整批只进入一次 tcpip 线程的上下文。
+	lwip::TcpIpCall(
+		[&]()
+		{
+			if (_pcb == nullptr)
+			{
+				throw std::runtime_error{std::string{CODE_POS_STR} + "必须先调用 Bind."};
+			}
+
+			for (lwip::UdpDatagram const &datagram : datagrams)
+			{
+				if (datagram._payload.Size() > UINT16_MAX)
+				{
+					_sending_error_count++;
+					continue;
+				}
+
+				bool pooled = false;
+				pbuf *p = TakeSendingPbuf(static_cast<uint16_t>(datagram._payload.Size()), pooled);
+				if (p == nullptr)
+				{
+					_sending_error_count++;
+					continue;
+				}
+
+				std::memcpy(p->payload, datagram._payload.Buffer(), datagram._payload.Size());
+
+				ip_addr_t remote_address{};
+				remote_address << datagram._remote_ip_address;
+				err_t result = udp_sendto(_pcb, p, &remote_address, datagram._remote_port);
+
+				if (pooled)
+				{
+					reused_count++;
+				}
+				else
+				{
+					pbuf_free(p);
+				}
+
+				if (result != err_enum_t::ERR_OK)
+				{
+					_sending_error_count++;
+					continue;
+				}
+
+				sent_count++;
+			}
+
+			_sent_datagram_count += sent_count;
+			_reused_pbuf_count += reused_count;
+		});
+
+	return sent_count;
+}
+
+int32_t lwip::UdpEndpoint::ReceiveBatch(int32_t max_count,
+										std::function<void(lwip::UdpDatagram const &)> const &callback)
+{
+	// 只有一个消费者时不会争用。
+	ReceivingLockGuard g{_receiving_lock};
+	ReceivedDatagram received_datagram{};
+	while (static_cast<int32_t>(_receiving_batch.size()) < max_count &&
+		   _receiving_ring.TryPop(received_datagram))
+	{
+		_receiving_batch.push_back(received_datagram);
+	}
+
+	int32_t count = static_cast<int32_t>(_receiving_batch.size());
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	try
+	{
+		for (ReceivedDatagram const &datagram : _receiving_batch)
+		{
+			lwip::UdpDatagram view{};
+			view._remote_ip_address = datagram._remote_ip_address;
+			view._remote_port = datagram._remote_port;
+			view._timestamp = datagram._timestamp;
+			view._payload = base::ReadOnlySpan{
+				reinterpret_cast<uint8_t const *>(datagram._pbuf->payload),
+				datagram._pbuf->len,
+			};
+
+			callback(view);
+		}
+	}
+	catch (...)
+	{
+		lwip::TcpIpCall(
+			[&]()
+			{
+				FreeReceivingBatch();
+			});
+
+		throw;
+	}
+
+	// 整批的 pbuf 在一次进入内核上下文时释放。
+	lwip::TcpIpCall(
+		[&]()
+		{
+			FreeReceivingBatch();
+		});
+
+	return count;
+}
+
+lwip::UdpEndpointStatistics lwip::UdpEndpoint::Statistics() const
+{
+	lwip::UdpEndpointStatistics statistics{};
+	statistics.sent_datagram_count = _sent_datagram_count;
+	statistics.sending_error_count = _sending_error_count;
+	statistics.reused_pbuf_count = _reused_pbuf_count;
+	statistics.received_datagram_count = _received_datagram_count;
+	statistics.dropped_datagram_count = _dropped_datagram_count;
+	return statistics;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "base/define.h"
+#include "base/task/BinarySemaphore.h"
+#include "base/net/IPAddress.h"
+#include "lwip-wrapper/SpscRing.h"
+#include "lwip-wrapper/UdpDatagram.h"
+#include "lwip-wrapper/UdpEndpointStatistics.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace lwip
+{
+	/// @brief 高速收发小 UDP 数据报的端点。
+	/// @note 与 socket 相比：
+	/// 	@li 一次发送一批数据报，整批只进入一次 tcpip 线程的上下文，而不是每个数据报都经过
+	/// 	一次邮箱往返。
+	/// 	@li 发送时复用预分配的 pbuf, 不必每个数据报都分配一次。
+	/// 	@li 接收到的数据报在 tcpip 线程中放入单生产者单消费者的无锁环形队列，应用成批取出。
+	/// 	引用以太网端口内存的负载入队前拷贝一次，应用持有多久都不影响网卡释放。
+	///
+	/// @warning SendBatch 可以在任意线程调用。ReceiveBatch 同一时刻只能由一个线程调用。
+	/// Close 可以在任意线程调用，它与 ReceiveBatch 互斥，不会与消费者同时取出接收队列。
+	class UdpEndpoint
+	{
+	private:
+		DELETE_COPY_AND_MOVE(UdpEndpoint)
+
+		/// @brief 预分配的发送用的 pbuf.
+		class PooledPbuf
+		{
+		public:
+			pbuf *_pbuf = nullptr;
+
+			/// @brief 分配时的负载指针。发送时 lwip 会在前面添加首部，复用前要恢复。
+			void *_payload = nullptr;
+		};
+
+		/// @brief 接收队列中的数据报。
+		class ReceivedDatagram
+		{
+		public:
+			/// @brief 单个 pbuf, 不是链表。
+			pbuf *_pbuf = nullptr;
+
+			base::IPAddress _remote_ip_address;
+			uint16_t _remote_port = 0;
+			lwip::FrameTimestamp _timestamp{};
+		};
+
+		udp_pcb *_pcb = nullptr;
+
+		std::vector<PooledPbuf> _sending_pbuf_pool;
+		uint16_t _sending_pbuf_size = 0;
+		std::size_t _next_sending_pbuf_index = 0;
+
+		lwip::SpscRing<ReceivedDatagram> _receiving_ring;
+
+		/// @brief ReceiveBatch 的暂存区。只由消费者访问。
+		std::vector<ReceivedDatagram> _receiving_batch;
+
+		/// @brief 消费者锁。ReceiveBatch 和 Close 持有它取出接收队列，接收队列始终只有一个
+		/// 消费者。
+		base::task::BinarySemaphore _receiving_lock{true};
+
+		std::atomic_uint64_t _sent_datagram_count = 0;
+		std::atomic_uint64_t _sending_error_count = 0;
+		std::atomic_uint64_t _reused_pbuf_count = 0;
+		std::atomic_uint64_t _received_datagram_count = 0;
+		std::atomic_uint64_t _dropped_datagram_count = 0;
+
+		/// @brief 取得一个负载大小为 size 的 pbuf. 优先复用池中空闲的 pbuf.
+		/// @note 在 tcpip 线程的上下文中调用。
+		/// @param size
+		/// @param pooled 复用了池中的 pbuf 时为 true, 调用者不能释放它。
+		/// @return 分配失败返回空指针。
+		pbuf *TakeSendingPbuf(uint16_t size, bool &pooled);
+
+		/// @brief 释放接收暂存区中的 pbuf. 需要在 lwip 内核上下文中调用。
+		void FreeReceivingBatch();
+
+		static void ReceivingFunc(void *arg, udp_pcb *pcb, pbuf *p, ip_addr_t const *addr, u16_t port);
+
+	public:
+		/// @brief 构造端点。
+		/// @param receiving_ring_capacity 接收队列的容量。必须是 2 的整数次幂。
+		/// @param sending_pbuf_count 预分配的发送用 pbuf 的个数。
+		/// @param sending_pbuf_size 预分配的 pbuf 的负载大小。更大的数据报临时分配 pbuf.
+		UdpEndpoint(uint32_t receiving_ring_capacity = 1024,
+					int32_t sending_pbuf_count = 32,
+					uint16_t sending_pbuf_size = 1472);
+
+		~UdpEndpoint();
+
+		/// @brief 绑定本地地址和端口，开始接收。
+		/// @param ip_address 传入 0.0.0.0 表示所有网卡。
+		/// @param port 传入 0 表示由 lwip 选择。
+		void Bind(base::IPAddress const &ip_address, uint16_t port);
+
+		/// @brief 关闭端点，丢弃还没有取出的数据报。
+		/// @note 正在执行的 ReceiveBatch 返回后才丢弃。
+		/// @warning 禁止在 ReceiveBatch 的回调中调用。
+		void Close();
+
+		/// @brief 发送一批数据报。
+		/// @note 负载在返回前就已经拷贝到 pbuf 中，返回后可以立刻复用。
+		/// @param datagrams
+		/// @return 发送成功的个数。
+		int32_t SendBatch(std::vector<lwip::UdpDatagram> const &datagrams);
+
+		/// @brief 取出一批接收到的数据报。
+		/// @param max_count 最多取出的个数。
+		/// @param callback 对每个数据报调用一次。数据报的负载只在回调期间有效。
+		/// @return 取出的个数。
+		int32_t ReceiveBatch(int32_t max_count, std::function<void(lwip::UdpDatagram const &)> const &callback);
+
+		/// @brief 统计数据。
+		/// @return
+		lwip::UdpEndpointStatistics Statistics() const;
+	};
+} // namespace lwip
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+namespace lwip
+{
+	/// @brief lwip::UdpEndpoint 的统计数据。
+	class UdpEndpointStatistics
+	{
+	public:
+		/// @brief 发送成功的数据报个数。
+		uint64_t sent_datagram_count = 0;
+
+		/// @brief 发送失败的数据报个数。
+		uint64_t sending_error_count = 0;
+
+		/// @brief 发送时复用了预分配的 pbuf 的次数。
+		uint64_t reused_pbuf_count = 0;
+
+		/// @brief 放入接收队列的数据报个数。
+		uint64_t received_datagram_count = 0;
+
+		/// @brief 因为接收队列满了而丢弃的数据报个数。
+		uint64_t dropped_datagram_count = 0;
+	};
+} // namespace lwip
@@ -0,0 +1,275 @@
+#include "lwip_chksum.h"
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+	#include <immintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
+/**
+ * 反码和与字节序无关：按本机字节序把数据读成 16 位的字，求和，再按本机字节序写回内存，
+ * 得到的字节与按网络字节序计算的结果相同。所以各个版本都直接按本机字节序读取，最后
+ * 折叠到 16 位即可。
+ *
+ * 32 位的字也一样，它的高半部分和低半部分就是两个 16 位的字，折叠时会加在一起。
+ */
+
+namespace
+{
+	/// @brief 将 64 位的部分和折叠到 16 位。
+	/// @param sum
+	/// @return
+	uint16_t Fold(uint64_t sum)
+	{
+		sum = (sum & 0xffffffffu) + (sum >> 32);
+		sum = (sum & 0xffffffffu) + (sum >> 32);
+		sum = (sum & 0xffffu) + (sum >> 16);
+		sum = (sum & 0xffffu) + (sum >> 16);
+		return static_cast<uint16_t>(sum);
+	}
+
+	/// @brief 每次处理一个 32 位字的通用版本。处理全部字节，包括末尾的奇数字节。
+	/// @tparam copy 是否同时拷贝到 dst.
+	/// @param src
+	/// @param dst
+	/// @param len
+	/// @return 64 位的部分和。
+	template <bool copy>
+	uint64_t SumWords(uint8_t const *src, uint8_t *dst, size_t len)
+	{
+		uint64_t sum = 0;
+
+		// 每轮 4 个字，减少循环开销，也让多个加法可以并行。
+		while (len >= 16)
+		{
+			uint32_t words[4];
+			std::memcpy(words, src, 16);
+			if constexpr (copy)
+			{
+				std::memcpy(dst, words, 16);
+				dst += 16;
+			}
+
+			sum += words[0];
+			sum += words[1];
+			sum += words[2];
+			sum += words[3];
+			src += 16;
+			len -= 16;
+		}
+
+		while (len >= 2)
+		{
+			uint16_t word;
+			std::memcpy(&word, src, 2);
+			if constexpr (copy)
+			{
+				std::memcpy(dst, &word, 2);
+				dst += 2;
+			}
+
+			sum += word;
+			src += 2;
+			len -= 2;
+		}
+
+		if (len == 1)
+		{
+			if constexpr (copy)
+			{
+				*dst = *src;
+			}
+
+			// 最后一个字节是一个 16 位字的第一个字节，另一个字节视为 0.
+			if constexpr (std::endian::native == std::endian::little)
+			{
+				sum += *src;
+			}
+			else
+			{
+				sum += static_cast<uint64_t>(*src) << 8;
+			}
+		}
+
+		return sum;
+	}
+
+	/* 以下 SIMD 版本把 16 位的字零扩展到 32 位的通道中累加。每轮每个通道加 2 个字，最多
+	 * 0x1fffe, 所以每处理 _block_size 字节就要把通道中的和转移到 64 位的和中，防止溢出。
+	 * 剩下不足一个向量的字节由通用版本处理。
+	 */
+	constexpr size_t _block_size = 64 * 1024;
+
+#if defined(__AVX2__)
+
+	template <bool copy>
+	uint64_t SumVectors(uint8_t const *&src, uint8_t *&dst, size_t &len)
+	{
+		uint64_t sum = 0;
+		__m256i const zero = _mm256_setzero_si256();
+		while (len >= 32)
+		{
+			size_t block_len = len < _block_size ? len : _block_size;
+			block_len &= ~static_cast<size_t>(31);
+
+			__m256i accumulator = _mm256_setzero_si256();
+			for (size_t i = 0; i < block_len; i += 32)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i));
+				if constexpr (copy)
+				{
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+				}
+
+				accumulator = _mm256_add_epi32(accumulator, _mm256_unpacklo_epi16(v, zero));
+				accumulator = _mm256_add_epi32(accumulator, _mm256_unpackhi_epi16(v, zero));
+			}
+
+			alignas(32) uint32_t lanes[8];
+			_mm256_store_si256(reinterpret_cast<__m256i *>(lanes), accumulator);
+			for (uint32_t lane : lanes)
+			{
+				sum += lane;
+			}
+
+			src += block_len;
+			if constexpr (copy)
+			{
+				dst += block_len;
+			}
+
+			len -= block_len;
+		}
+
+		return sum;
+	}
+
+#elif defined(__SSE2__)
+
+	template <bool copy>
+	uint64_t SumVectors(uint8_t const *&src, uint8_t *&dst, size_t &len)
+	{
+		uint64_t sum = 0;
+		__m128i const zero = _mm_setzero_si128();
+		while (len >= 16)
+		{
+			size_t block_len = len < _block_size ? len : _block_size;
+			block_len &= ~static_cast<size_t>(15);
+
+			__m128i accumulator = _mm_setzero_si128();
+			for (size_t i = 0; i < block_len; i += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i));
+				if constexpr (copy)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+				}
+
+				accumulator = _mm_add_epi32(accumulator, _mm_unpacklo_epi16(v, zero));
+				accumulator = _mm_add_epi32(accumulator, _mm_unpackhi_epi16(v, zero));
+			}
+
+			alignas(16) uint32_t lanes[4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(lanes), accumulator);
+			for (uint32_t lane : lanes)
+			{
+				sum += lane;
+			}
+
+			src += block_len;
+			if constexpr (copy)
+			{
+				dst += block_len;
+			}
+
+			len -= block_len;
+		}
+
+		return sum;
+	}
+
+#elif defined(__ARM_NEON)
+
+	template <bool copy>
+	uint64_t SumVectors(uint8_t const *&src, uint8_t *&dst, size_t &len)
+	{
+		uint64_t sum = 0;
+		while (len >= 16)
+		{
+			size_t block_len = len < _block_size ? len : _block_size;
+			block_len &= ~static_cast<size_t>(15);
+
+			uint32x4_t accumulator = vdupq_n_u32(0);
+			for (size_t i = 0; i < block_len; i += 16)
+			{
+				uint8x16_t bytes = vld1q_u8(src + i);
+				if constexpr (copy)
+				{
+					vst1q_u8(dst + i, bytes);
+				}
+
+				// 相邻两个 16 位字相加后累加到 32 位通道。
+				accumulator = vpadalq_u16(accumulator, vreinterpretq_u16_u8(bytes));
+			}
+
+			uint32_t lanes[4];
+			vst1q_u32(lanes, accumulator);
+			for (uint32_t lane : lanes)
+			{
+				sum += lane;
+			}
+
+			src += block_len;
+			if constexpr (copy)
+			{
+				dst += block_len;
+			}
+
+			len -= block_len;
+		}
+
+		return sum;
+	}
+
+#else
+
+	template <bool copy>
+	uint64_t SumVectors(uint8_t const *&src, uint8_t *&dst, size_t &len)
+	{
+		// 没有 SIMD, 全部交给通用版本。
+		(void)src;
+		(void)dst;
+		(void)len;
+		return 0;
+	}
+
+#endif
+
+	template <bool copy>
+	uint16_t Checksum(uint8_t const *src, uint8_t *dst, size_t len)
+	{
+		uint64_t sum = SumVectors<copy>(src, dst, len);
+
+		// 64 位的和最多累加 2^32 个 32 位的字也不会溢出，len 远远达不到。
+		sum += SumWords<copy>(src, dst, len);
+		return Fold(sum);
+	}
+} // namespace
+
+uint16_t lwip_wrapper_chksum(void const *data, int len)
+{
+	if (len <= 0)
+	{
+		return 0;
+	}
+
+	return Checksum<false>(static_cast<uint8_t const *>(data), nullptr, static_cast<size_t>(len));
+}
+
+uint16_t lwip_wrapper_chksum_copy(void *dst, void const *src, uint16_t len)
+{
+	return Checksum<true>(static_cast<uint8_t const *>(src), static_cast<uint8_t *>(dst), len);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * 替换 lwip 的 Internet 校验和算法。在 lwipopts.h 中加入
+ *
+ *		#include "lwip-wrapper/lwip_chksum.h"
+ *		#define LWIP_CHKSUM lwip_wrapper_chksum
+ *		#define LWIP_CHECKSUM_ON_COPY 1
+ *		#define LWIP_CHKSUM_COPY(dst, src, len) lwip_wrapper_chksum_copy(dst, src, len)
+ *
+ * 后 lwip 就会使用本文件的实现。不要定义 LWIP_CHKSUM_COPY_ALGORITHM, 定义了 LWIP_CHKSUM_COPY
+ * 时 lwip 的 inet_chksum.h 会自己把它定义为 0. 拷贝时计算校验和只在 LWIP_CHECKSUM_ON_COPY
+ * 为 1 时使用，不需要它时可以只定义 LWIP_CHKSUM.
+ *
+ * 编译时按目标平台选择最快的版本：AVX2, SSE2, NEON, 都没有时使用每次处理一个机器字的
+ * 通用版本。
+ *
+ * 本文件会被 lwip 的 C 源文件包含，所以只能使用 C 的语法，也不能包含 lwip 的头文件。
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	/// @brief 计算反码和，语义与 lwip_standard_chksum 相同。
+	/// @param data
+	/// @param len 字节数。
+	/// @return 折叠到 16 位的反码和，没有取反，字节序与数据在内存中的字节序相同。
+	uint16_t lwip_wrapper_chksum(void const *data, int len);
+
+	/// @brief 将 src 拷贝到 dst, 同时计算反码和。
+	/// @param dst
+	/// @param src
+	/// @param len 字节数。
+	/// @return 与 lwip_wrapper_chksum 相同。
+	uint16_t lwip_wrapper_chksum_copy(void *dst, void const *src, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
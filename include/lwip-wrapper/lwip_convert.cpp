@@ -41,3 +41,24 @@ base::IPAddress &base::operator<<(base::IPAddress &out, ip_addr_t const &in)
 		throw std::runtime_error{CODE_POS_STR + e.what()};
 	}
 }
+
+eth_addr &base::operator<<(eth_addr &out, base::Mac const &in)
+{
+	try
+	{
+		base::Span span{
+			out.addr,
+			sizeof(out.addr),
+		};
+
+		span.CopyFrom(in.Span());
+
+		// base::Mac 用小端序储存 MAC 地址，而 eth_addr 是按网络上传输的顺序，所以要翻转。
+		span.Reverse();
+		return out;
+	}
+	catch (std::exception const &e)
+	{
+		throw std::runtime_error{CODE_POS_STR + e.what()};
+	}
+}
@@ -1,10 +1,14 @@
 #pragma once
 #include <base/net/IPAddress.h>
+#include <base/net/Mac.h>
 #include <lwip/netif.h>
+#include <lwip/prot/ethernet.h>
 
 namespace base
 {
 	ip_addr_t &operator<<(ip_addr_t &out, base::IPAddress const &in);
 
 	base::IPAddress &operator<<(base::IPAddress &out, ip_addr_t const &in);
+
+	eth_addr &operator<<(eth_addr &out, base::Mac const &in);
 } // namespace base
@@ -0,0 +1,14 @@
+#include "lwip_hooks.h"
+#include "lwip-wrapper/NetifSlot.h"
+
+netif *lwip_wrapper_ip4_route_src(ip4_addr_t const *src, ip4_addr_t const *dest)
+{
+	// 路由表只按目的地址匹配。
+	(void)src;
+	return lwip::net_if_slot().Routes().FindNetif(dest);
+}
+
+ip4_addr_t const *lwip_wrapper_etharp_get_gw(netif *netif, ip4_addr_t const *dest)
+{
+	return lwip::net_if_slot().Routes().FindGateway(netif, dest);
+}
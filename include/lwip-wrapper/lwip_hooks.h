@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+ * lwip 的钩子文件。在 lwipopts.h 中定义
+ *
+ *		#define LWIP_HOOK_FILENAME "lwip-wrapper/lwip_hooks.h"
+ *
+ * 后，lwip 的路由和 ARP 就会使用 NetifSlot 中的路由表。本文件会被 lwip 的 C 源文件包含，
+ * 所以只能使用 C 的语法。
+ */
+
+#include "lwip/ip4_addr.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	struct netif;
+
+	/// @brief 在 NetifSlot 的路由表中查找到达 dest 的出口网卡。
+	/// @param src 源地址。lwip 在查找非本地子网的路由时会传入空指针。
+	/// @param dest 目的地址。
+	/// @return 找不到返回空指针，lwip 会继续使用默认网卡。
+	struct netif *lwip_wrapper_ip4_route_src(ip4_addr_t const *src, ip4_addr_t const *dest);
+
+	/// @brief 在 NetifSlot 的路由表中查找经 netif 到达 dest 的下一跳。
+	/// @param netif 出口网卡。
+	/// @param dest 目的地址。
+	/// @return 找不到返回空指针，lwip 会继续使用 netif 的默认网关。
+	ip4_addr_t const *lwip_wrapper_etharp_get_gw(struct netif *netif, ip4_addr_t const *dest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define LWIP_HOOK_IP4_ROUTE_SRC(src, dest) lwip_wrapper_ip4_route_src(src, dest)
+#define LWIP_HOOK_ETHARP_GET_GW(netif, dest) lwip_wrapper_etharp_get_gw(netif, dest)
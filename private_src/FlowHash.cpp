@@ -0,0 +1,104 @@
+#include "FlowHash.h"
+
+namespace
+{
+	constexpr uint32_t _ethernet_header_size = 14;
+	constexpr uint32_t _vlan_tag_size = 4;
+	constexpr uint16_t _ethernet_type_ipv4 = 0x0800;
+	constexpr uint16_t _ethernet_type_vlan = 0x8100;
+	constexpr uint8_t _ip_protocol_tcp = 6;
+	constexpr uint8_t _ip_protocol_udp = 17;
+
+	uint16_t ReadBigEndian16(uint8_t const *buffer)
+	{
+		return static_cast<uint16_t>((buffer[0] << 8) | buffer[1]);
+	}
+
+	uint32_t ReadBigEndian32(uint8_t const *buffer)
+	{
+		return (static_cast<uint32_t>(buffer[0]) << 24) |
+			   (static_cast<uint32_t>(buffer[1]) << 16) |
+			   (static_cast<uint32_t>(buffer[2]) << 8) |
+			   static_cast<uint32_t>(buffer[3]);
+	}
+
+	/// @brief 将哈希值的高位折叠到低位，让取模时高位也能参与。
+	/// @param hash
+	/// @return
+	uint32_t Fold(uint32_t hash)
+	{
+		hash ^= hash >> 16;
+		hash ^= hash >> 8;
+		return hash;
+	}
+
+	uint32_t L2Hash(uint8_t const *frame)
+	{
+		uint32_t hash = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			// 目的 MAC 与源 MAC 对应字节异或，这样两个方向的帧哈希值相同。
+			hash = (hash << 5) ^ (hash >> 27) ^ (frame[i] ^ frame[6 + i]);
+		}
+
+		return Fold(hash);
+	}
+} // namespace
+
+uint32_t lwip::FlowHash(base::ReadOnlySpan const &span, lwip::BondingHashPolicy policy)
+{
+	uint32_t size = static_cast<uint32_t>(span.Size());
+	if (size < _ethernet_header_size)
+	{
+		return 0;
+	}
+
+	uint8_t const *frame = span.Buffer();
+	uint32_t l2_hash = L2Hash(frame);
+	if (policy == lwip::BondingHashPolicy::L2)
+	{
+		return l2_hash;
+	}
+
+	uint32_t offset = _ethernet_header_size;
+	uint16_t ethernet_type = ReadBigEndian16(frame + 12);
+	if (ethernet_type == _ethernet_type_vlan && size >= _ethernet_header_size + _vlan_tag_size)
+	{
+		ethernet_type = ReadBigEndian16(frame + 16);
+		offset += _vlan_tag_size;
+	}
+
+	// IPv4 头最短 20 字节。
+	if (ethernet_type != _ethernet_type_ipv4 || size < offset + 20)
+	{
+		return l2_hash;
+	}
+
+	uint8_t const *ip_header = frame + offset;
+	uint32_t ip_header_size = (ip_header[0] & 0x0f) * 4u;
+	if (ip_header_size < 20)
+	{
+		return l2_hash;
+	}
+
+	uint32_t hash = ReadBigEndian32(ip_header + 12) ^ ReadBigEndian32(ip_header + 16);
+	if (policy == lwip::BondingHashPolicy::L3)
+	{
+		return Fold(hash);
+	}
+
+	// 只有未分片的报文，或分片中的第一片才带有 TCP/UDP 头。为了让同一个报文的各个分片
+	// 走同一个端口，所有分片都不参与端口号哈希。
+	bool is_fragment = (ReadBigEndian16(ip_header + 6) & 0x3fff) != 0;
+	uint8_t protocol = ip_header[9];
+	if (is_fragment ||
+		(protocol != _ip_protocol_tcp && protocol != _ip_protocol_udp) ||
+		size < offset + ip_header_size + 4)
+	{
+		return Fold(hash);
+	}
+
+	// 源端口和目的端口刚好是 TCP/UDP 头的前 4 个字节。
+	hash ^= ReadBigEndian32(ip_header + ip_header_size);
+	return Fold(hash);
+}
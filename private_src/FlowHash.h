@@ -0,0 +1,15 @@
+#pragma once
+#include "base/net/Mac.h"
+#include "lwip-wrapper/BondingHashPolicy.h"
+#include <cstdint>
+
+namespace lwip
+{
+	/// @brief 计算以太网帧的流哈希值。
+	/// @note 发送 pbuf 链表时传入第一个 pbuf 即可。lwip 发送时以太网头、IP 头、TCP/UDP 头
+	/// 都在第一个 pbuf 中，解析不到的字段会使哈希退化为更低一层的策略。
+	/// @param span 以太网帧。
+	/// @param policy 哈希策略。
+	/// @return
+	uint32_t FlowHash(base::ReadOnlySpan const &span, lwip::BondingHashPolicy policy);
+} // namespace lwip
@@ -0,0 +1,74 @@
+#include "InputPbuf.h"
+
+void lwip::InputPbuf::Free(pbuf *p)
+{
+	InputPbuf *input_pbuf = reinterpret_cast<InputPbuf *>(p);
+	std::shared_ptr<std::atomic_int32_t> outstanding_count = std::move(input_pbuf->_outstanding_count);
+	delete input_pbuf;
+
+	// 最后一步。计数归零后网卡可能立刻被析构，这里持有的引用让计数本身继续有效。
+	outstanding_count->fetch_sub(1);
+}
+
+pbuf *lwip::InputPbuf::Alloc(base::ReadOnlySpan const &frame,
+							 std::shared_ptr<std::atomic_int32_t> const &outstanding_count,
+							 lwip::FrameTimestamp const *timestamp)
+{
+	InputPbuf *input_pbuf = new InputPbuf{};
+	input_pbuf->_custom.custom_free_function = Free;
+	input_pbuf->_outstanding_count = outstanding_count;
+	if (timestamp != nullptr)
+	{
+		input_pbuf->_timestamp = *timestamp;
+	}
+
+	outstanding_count->fetch_add(1);
+	return pbuf_alloced_custom(PBUF_RAW,
+							   frame.Size(),
+							   PBUF_REF,
+							   &input_pbuf->_custom,
+							   const_cast<uint8_t *>(frame.Buffer()),
+							   frame.Size());
+}
+
+bool lwip::InputPbuf::IsInputPbuf(pbuf const *p)
+{
+	if (p == nullptr || (p->flags & PBUF_FLAG_IS_CUSTOM) == 0)
+	{
+		return false;
+	}
+
+	// 用释放函数识别本类创建的 pbuf.
+	pbuf_custom const *custom = reinterpret_cast<pbuf_custom const *>(p);
+	return custom->custom_free_function == Free;
+}
+
+bool lwip::InputPbuf::ReferencesFrame(pbuf const *p)
+{
+	for (pbuf const *current = p; current != nullptr; current = current->next)
+	{
+		if (IsInputPbuf(current))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool lwip::InputPbuf::TryGetTimestamp(pbuf const *p, lwip::FrameTimestamp &timestamp)
+{
+	if (!IsInputPbuf(p))
+	{
+		return false;
+	}
+
+	InputPbuf const *input_pbuf = reinterpret_cast<InputPbuf const *>(p);
+	if (!input_pbuf->_timestamp.IsValid())
+	{
+		return false;
+	}
+
+	timestamp = input_pbuf->_timestamp;
+	return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "base/net/Mac.h"
+#include "lwip-wrapper/FrameTimestamp.h"
+#include "lwip/pbuf.h"
+#include <atomic>
+#include <memory>
+
+namespace lwip
+{
+	/// @brief NetifWrapper 接收帧时创建的 pbuf. 引用帧的内存，不拷贝。
+	/// @note 在 pbuf_custom 后面附带接收时间戳，以及所属网卡的未释放 pbuf 计数。网卡释放资源前
+	/// 会等待计数归零，确保 lwip 不再引用以太网端口的内存。计数由网卡和 pbuf 共同持有，等待
+	/// 超时后网卡先析构，pbuf 释放时计数仍然有效。
+	///
+	/// @note 本库交给应用的 pbuf, 即 UdpEndpoint 的接收环和 TcpConnection 的 PbufChain, 都是
+	/// 拷贝，不是本类的 pbuf. 所以网卡释放时只需要等待 lwip 自身暂存的 pbuf.
+	class InputPbuf
+	{
+	private:
+		/// @brief 必须是第一个字段，pbuf 指针才能转换为本类的指针。
+		pbuf_custom _custom{};
+
+		std::shared_ptr<std::atomic_int32_t> _outstanding_count;
+		lwip::FrameTimestamp _timestamp{};
+
+		static void Free(pbuf *p);
+
+		static bool IsInputPbuf(pbuf const *p);
+
+	public:
+		/// @brief 创建一个引用 frame 的 pbuf.
+		/// @param frame
+		/// @param outstanding_count 创建时加 1, 释放时减 1.
+		/// @param timestamp 接收时间戳。为空指针表示不记录。
+		/// @return
+		static pbuf *Alloc(base::ReadOnlySpan const &frame,
+						   std::shared_ptr<std::atomic_int32_t> const &outstanding_count,
+						   lwip::FrameTimestamp const *timestamp);
+
+		/// @brief 检查 pbuf 链表中是否有本类创建的 pbuf, 即是否引用着以太网端口的内存。
+		/// @note 要交给应用长期持有的 pbuf 链表，引用着端口的内存时要先拷贝，否则网卡释放时
+		/// 只能等待应用释放它们。
+		/// @param p
+		/// @return
+		static bool ReferencesFrame(pbuf const *p);
+
+		/// @brief 读取 pbuf 中的接收时间戳。
+		/// @param p
+		/// @param timestamp
+		/// @return p 不是本类创建的，或者没有记录时间戳，返回 false.
+		static bool TryGetTimestamp(pbuf const *p, lwip::FrameTimestamp &timestamp);
+	};
+} // namespace lwip
@@ -3,3 +3,13 @@ target_import_src(${ProjectName})
 
 target_import_lwip(${ProjectName} PUBLIC)
 target_import_bsp_interface(${ProjectName} PUBLIC)
+
+option(LWIP_WRAPPER_BUILD_TESTS "构建 lwip-wrapper 的测试。" OFF)
+if(LWIP_WRAPPER_BUILD_TESTS)
+	include(${CMAKE_CURRENT_LIST_DIR}/test/test.cmake)
+endif()
+
+option(LWIP_WRAPPER_BUILD_BENCHMARKS "构建 lwip-wrapper 的性能测试。" OFF)
+if(LWIP_WRAPPER_BUILD_BENCHMARKS)
+	include(${CMAKE_CURRENT_LIST_DIR}/bench/bench.cmake)
+endif()
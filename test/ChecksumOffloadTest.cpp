@@ -0,0 +1,246 @@
+#include "base/task/delay.h"
+#include "EthernetFrame.h"
+#include "InMemoryEthernetPort.h"
+#include "lwip-wrapper/NetifSlot.h"
+#include "lwip-wrapper/NetifWrapper.h"
+#include "lwip-wrapper/UdpEndpoint.h"
+#include "TestHelper.h"
+#include <atomic>
+#include <string>
+
+namespace
+{
+	std::array<uint8_t, 6> const LocalMac{0x02, 0x00, 0x00, 0x00, 0x01, 0x01};
+	std::array<uint8_t, 6> const RemoteMac{0x02, 0x00, 0x00, 0x00, 0x01, 0x02};
+	std::array<uint8_t, 4> const LocalIPAddress{192, 168, 101, 1};
+	std::array<uint8_t, 4> const RemoteIPAddress{192, 168, 101, 2};
+	constexpr uint16_t LocalPort = 5000;
+	constexpr uint16_t RemotePort = 6000;
+
+	lwip::ChecksumOffloadCapability FullCapability()
+	{
+		lwip::ChecksumOffloadCapability capability{};
+		capability.ip_generation = true;
+		capability.ip_checking = true;
+		capability.udp_generation = true;
+		capability.udp_checking = true;
+		capability.tcp_generation = true;
+		capability.tcp_checking = true;
+		capability.icmp_generation = true;
+		capability.icmp_checking = true;
+		return capability;
+	}
+
+	void OpenNetif(lwip::NetifWrapper &netif, std::vector<base::ethernet::IEthernetPort *> const &ports)
+	{
+		netif.Open(ports,
+				   lwip::BondingHashPolicy::L2,
+				   lwip::test::MakeMac(LocalMac),
+				   lwip::test::MakeIPAddress(LocalIPAddress),
+				   lwip::test::MakeIPAddress({255, 255, 255, 0}),
+				   lwip::test::MakeIPAddress({192, 168, 101, 254}),
+				   1500);
+	}
+
+	/// @brief 聚合网卡只卸载所有成员都支持的项目。
+	void Negotiate()
+	{
+		lwip::test::InMemoryEthernetPort port_a{};
+		lwip::ChecksumOffloadCapability capability_a{};
+		capability_a.ip_generation = true;
+		capability_a.udp_generation = true;
+		capability_a.udp_checking = true;
+		port_a.SetChecksumOffloadCapability(capability_a);
+
+		lwip::test::InMemoryEthernetPort port_b{};
+		lwip::ChecksumOffloadCapability capability_b{};
+		capability_b.udp_generation = true;
+		capability_b.tcp_checking = true;
+		port_b.SetChecksumOffloadCapability(capability_b);
+
+		lwip::NetifWrapper netif{"offload-negotiate"};
+		OpenNetif(netif, {&port_a, &port_b});
+
+		lwip::ChecksumOffloadCapability capability = netif.ChecksumOffloadCapability();
+		netif.Dispose();
+
+		lwip::test::Check(capability.udp_generation, "两个成员都支持的 udp_generation 没有卸载。");
+		lwip::test::Check(!capability.ip_generation, "只有一个成员支持的 ip_generation 被卸载了。");
+		lwip::test::Check(!capability.udp_checking, "只有一个成员支持的 udp_checking 被卸载了。");
+		lwip::test::Check(!capability.tcp_checking, "只有一个成员支持的 tcp_checking 被卸载了。");
+	}
+
+	/// @brief 检查 lwip 是否用软件计算 flag 对应的校验和。
+	bool ComputedBySoftware(lwip::NetifWrapper &netif, u16_t flag)
+	{
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+		return (netif.WrappedObj()->chksum_flags & flag) != 0;
+#else
+		(void)netif;
+		(void)flag;
+		return true;
+#endif
+	}
+
+	/// @brief 网桥中的网卡只卸载所有网卡都支持的项目，关闭网桥后恢复。
+	void Bridge()
+	{
+		lwip::test::InMemoryEthernetPort port_a{};
+		port_a.SetChecksumOffloadCapability(FullCapability());
+
+		lwip::test::InMemoryEthernetPort port_b{};
+		lwip::ChecksumOffloadCapability capability_b{};
+		capability_b.udp_generation = true;
+		port_b.SetChecksumOffloadCapability(capability_b);
+
+		std::shared_ptr<lwip::NetifWrapper> netif_a{new lwip::NetifWrapper{"offload-bridge-a"}};
+		std::shared_ptr<lwip::NetifWrapper> netif_b{new lwip::NetifWrapper{"offload-bridge-b"}};
+		OpenNetif(*netif_a, {&port_a});
+		OpenNetif(*netif_b, {&port_b});
+
+		lwip::NetifSlot slot{};
+		slot.PlugIn(netif_a);
+		slot.PlugIn(netif_b);
+		slot.EnableBridge();
+
+		bool a_udp_generation_offloaded = !ComputedBySoftware(*netif_a, NETIF_CHECKSUM_GEN_UDP);
+		bool a_tcp_generation_offloaded = !ComputedBySoftware(*netif_a, NETIF_CHECKSUM_GEN_TCP);
+		bool a_ip_checking_offloaded = !ComputedBySoftware(*netif_a, NETIF_CHECKSUM_CHECK_IP);
+
+		slot.DisableBridge();
+		bool a_tcp_generation_restored = !ComputedBySoftware(*netif_a, NETIF_CHECKSUM_GEN_TCP);
+
+		slot.Remove(netif_a->Name());
+		slot.Remove(netif_b->Name());
+		netif_a->Dispose();
+		netif_b->Dispose();
+
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+		lwip::test::Check(a_udp_generation_offloaded, "两张网卡都支持的 udp_generation 没有卸载。");
+		lwip::test::Check(!a_tcp_generation_offloaded, "只有一张网卡支持的 tcp_generation 被卸载了。");
+		lwip::test::Check(!a_ip_checking_offloaded, "只有一张网卡支持的 ip_checking 被卸载了。");
+		lwip::test::Check(a_tcp_generation_restored, "关闭网桥后没有恢复卸载。");
+#else
+		(void)a_udp_generation_offloaded;
+		(void)a_tcp_generation_offloaded;
+		(void)a_ip_checking_offloaded;
+		(void)a_tcp_generation_restored;
+#endif
+	}
+
+	/// @brief 无论是否卸载，线上的帧的校验和都正确，校验和错误的帧都不会交给应用。
+	/// @param offload 端口是否卸载所有校验和。
+	void SendAndReceive(bool offload)
+	{
+		lwip::test::InMemoryEthernetPort port{};
+		if (offload)
+		{
+			port.SetChecksumOffloadCapability(FullCapability());
+		}
+
+		std::atomic_int sent_count = 0;
+		std::atomic_int invalid_count = 0;
+		port.SetSendingCallback(
+			[&](base::ReadOnlySpan const &frame)
+			{
+				std::vector<uint8_t> copy{frame.Buffer(), frame.Buffer() + frame.Size()};
+				lwip::test::Ipv4FrameLayout layout{};
+				if (!layout.TryParse(copy.data(), frame.Size()) || layout._protocol != lwip::test::IpProtocolUdp)
+				{
+					return;
+				}
+
+				sent_count++;
+				if (!layout.IpHeaderChecksumIsValid() || !layout.PayloadChecksumIsValid())
+				{
+					invalid_count++;
+				}
+			});
+
+		lwip::NetifWrapper netif{offload ? "offload-on" : "offload-off"};
+		OpenNetif(netif, {&port});
+		port.LinkUp();
+		netif.AddStaticArpEntry(lwip::test::MakeIPAddress(RemoteIPAddress), lwip::test::MakeMac(RemoteMac));
+
+		{
+			lwip::UdpEndpoint endpoint{};
+			endpoint.Bind(lwip::test::MakeIPAddress(LocalIPAddress), LocalPort);
+
+			// 奇数和偶数长度都有，校验和的最后一个字节要补 0.
+			std::vector<uint8_t> payload(1400, 0x5a);
+			std::vector<lwip::UdpDatagram> datagrams;
+			for (int32_t size : {0, 1, 2, 17, 64, 555, 1400})
+			{
+				lwip::UdpDatagram datagram{};
+				datagram._remote_ip_address = lwip::test::MakeIPAddress(RemoteIPAddress);
+				datagram._remote_port = RemotePort;
+				datagram._payload = base::ReadOnlySpan{payload.data(), size};
+				datagrams.push_back(datagram);
+			}
+
+			int32_t sent = endpoint.SendBatch(datagrams);
+			lwip::test::Check(sent == static_cast<int32_t>(datagrams.size()), "SendBatch 没有全部发送。");
+			lwip::test::Check(sent_count == sent, "端口没有收到全部的 UDP 帧。");
+			lwip::test::Check(invalid_count == 0, std::to_string(invalid_count) + " 个发出的帧的校验和错误。");
+
+			// 先注入校验和错误的帧，再注入正确的帧。收到正确的帧时，错误的帧肯定已经被处理过了。
+			std::vector<uint8_t> bad_frame = lwip::test::BuildUdpFrame(LocalMac,
+																	   RemoteMac,
+																	   RemoteIPAddress,
+																	   LocalIPAddress,
+																	   RemotePort,
+																	   LocalPort,
+																	   33);
+			bad_frame.back() ^= 0xff;
+
+			std::vector<uint8_t> good_frame = lwip::test::BuildUdpFrame(LocalMac,
+																		RemoteMac,
+																		RemoteIPAddress,
+																		LocalIPAddress,
+																		RemotePort,
+																		LocalPort,
+																		44);
+
+			port.Receive(base::ReadOnlySpan{bad_frame.data(), static_cast<int32_t>(bad_frame.size())});
+			port.Receive(base::ReadOnlySpan{good_frame.data(), static_cast<int32_t>(good_frame.size())});
+
+			int good_count = 0;
+			int bad_count = 0;
+			for (int i = 0; i < 1000 && good_count == 0; i++)
+			{
+				endpoint.ReceiveBatch(16,
+									  [&](lwip::UdpDatagram const &datagram)
+									  {
+										  if (datagram._payload.Size() == 44)
+										  {
+											  good_count++;
+										  }
+										  else
+										  {
+											  bad_count++;
+										  }
+									  });
+
+				base::task::Delay(std::chrono::milliseconds{1});
+			}
+
+			lwip::test::Check(good_count == 1, "校验和正确的帧没有交给应用。");
+			lwip::test::Check(bad_count == 0, "校验和错误的帧被交给了应用。");
+		}
+
+		netif.Dispose();
+	}
+
+	void TestChecksumOffload()
+	{
+		Negotiate();
+		Bridge();
+		SendAndReceive(false);
+		SendAndReceive(true);
+	}
+} // namespace
+
+int main()
+{
+	return lwip::test::Run("NetifWrapper: 校验和卸载", TestChecksumOffload);
+}
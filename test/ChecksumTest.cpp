@@ -0,0 +1,107 @@
+#include "lwip-wrapper/lwip_chksum.h"
+#include "ReferenceChecksum.h"
+#include "TestHelper.h"
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	/// @brief 参照版本的 32 位累加和不溢出的最大长度。
+	constexpr int MaxLength = 131070;
+
+	/// @brief 多出来的字节用来把起始地址错开。
+	constexpr int MaxOffset = 64;
+
+	std::string Describe(int offset, int length)
+	{
+		return "offset = " + std::to_string(offset) + ", length = " + std::to_string(length);
+	}
+
+	void CheckChecksum(uint8_t const *data, int offset, int length)
+	{
+		uint16_t expected = lwip::test::lwip_standard_chksum(data + offset, length);
+		uint16_t actual = lwip_wrapper_chksum(data + offset, length);
+		lwip::test::Check(actual == expected, "lwip_wrapper_chksum 与 lwip_standard_chksum 不一致：" +
+												  Describe(offset, length));
+	}
+
+	void CheckChecksumCopy(uint8_t const *data, uint8_t *destination, int offset, int length)
+	{
+		std::memset(destination, 0xa5, MaxLength + MaxOffset);
+		uint16_t expected = lwip::test::lwip_standard_chksum(data + offset, length);
+		uint16_t actual = lwip_wrapper_chksum_copy(destination + offset, data + offset, static_cast<uint16_t>(length));
+		lwip::test::Check(actual == expected, "lwip_wrapper_chksum_copy 的校验和不正确：" + Describe(offset, length));
+		lwip::test::Check(std::memcmp(destination + offset, data + offset, length) == 0,
+						  "lwip_wrapper_chksum_copy 拷贝的数据不正确：" + Describe(offset, length));
+
+		// 不能写出界。
+		lwip::test::Check(offset == 0 || destination[offset - 1] == 0xa5, "lwip_wrapper_chksum_copy 写到了前面：" +
+																			   Describe(offset, length));
+		lwip::test::Check(destination[offset + length] == 0xa5, "lwip_wrapper_chksum_copy 写到了后面：" +
+																	 Describe(offset, length));
+	}
+
+	void Fuzz()
+	{
+		std::mt19937 random{20261018};
+		std::vector<uint8_t> data(MaxLength + MaxOffset);
+		std::vector<uint8_t> destination(MaxLength + MaxOffset);
+
+		// 全 0xff 时累加和最大，最容易暴露进位的错误。
+		for (int pattern = 0; pattern < 3; pattern++)
+		{
+			for (uint8_t &byte : data)
+			{
+				byte = pattern == 0 ? 0xff : static_cast<uint8_t>(random());
+			}
+
+			// 短的长度和所有的起始对齐都逐个检查。
+			for (int offset = 0; offset < MaxOffset; offset++)
+			{
+				for (int length = 0; length <= 300; length++)
+				{
+					CheckChecksum(data.data(), offset, length);
+					CheckChecksumCopy(data.data(), destination.data(), offset, length);
+				}
+			}
+
+			// 常见的帧长附近。
+			for (int length : {575, 576, 577, 1499, 1500, 1501, 1514, 8999, 9000, 9001, 65534, 65535})
+			{
+				for (int offset = 0; offset < 4; offset++)
+				{
+					CheckChecksum(data.data(), offset, length);
+					CheckChecksumCopy(data.data(), destination.data(), offset, length);
+				}
+			}
+
+			// 超过 64 KiB, 跨越分块计算的边界。拷贝版本的长度是 16 位的，不适用。
+			for (int length : {65536, 65537, 65538, 98304, 131069, MaxLength})
+			{
+				for (int offset = 0; offset < 4; offset++)
+				{
+					CheckChecksum(data.data(), offset, length);
+				}
+			}
+
+			// 随机的长度和对齐。
+			for (int i = 0; i < 2000; i++)
+			{
+				int offset = static_cast<int>(random() % MaxOffset);
+				int length = static_cast<int>(random() % (MaxLength + 1));
+				CheckChecksum(data.data(), offset, length);
+				if (length <= UINT16_MAX)
+				{
+					CheckChecksumCopy(data.data(), destination.data(), offset, length);
+				}
+			}
+		}
+	}
+} // namespace
+
+int main()
+{
+	return lwip::test::Run("lwip_chksum: 与 lwip_standard_chksum 对比", Fuzz);
+}
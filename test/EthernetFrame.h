@@ -0,0 +1,250 @@
+#pragma once
+#include "base/net/IPAddress.h"
+#include "base/net/Mac.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace lwip::test
+{
+	constexpr uint16_t EtherTypeIPv4 = 0x0800;
+	constexpr uint8_t IpProtocolIcmp = 1;
+	constexpr uint8_t IpProtocolTcp = 6;
+	constexpr uint8_t IpProtocolUdp = 17;
+	constexpr int32_t EthernetHeaderSize = 14;
+	constexpr int32_t Ipv4HeaderSize = 20;
+	constexpr int32_t UdpHeaderSize = 8;
+
+	inline base::Mac MakeMac(std::array<uint8_t, 6> const &bytes)
+	{
+		return base::Mac{std::endian::big, base::ReadOnlySpan{bytes.data(), static_cast<int32_t>(bytes.size())}};
+	}
+
+	inline base::IPAddress MakeIPAddress(std::array<uint8_t, 4> const &bytes)
+	{
+		return base::IPAddress{std::endian::big, base::ReadOnlySpan{bytes.data(), static_cast<int32_t>(bytes.size())}};
+	}
+
+	inline uint16_t ReadUInt16(uint8_t const *p)
+	{
+		return static_cast<uint16_t>((p[0] << 8) | p[1]);
+	}
+
+	inline void WriteUInt16(uint8_t *p, uint16_t value)
+	{
+		p[0] = static_cast<uint8_t>(value >> 8);
+		p[1] = static_cast<uint8_t>(value);
+	}
+
+	/// @brief 按网络字节序把 16 位的字累加到 sum 上，不折叠。
+	/// @param data
+	/// @param size
+	/// @param sum
+	/// @return
+	inline uint32_t AddWords(uint8_t const *data, int32_t size, uint32_t sum)
+	{
+		for (int32_t i = 0; i + 1 < size; i += 2)
+		{
+			sum += ReadUInt16(data + i);
+		}
+
+		if (size % 2 != 0)
+		{
+			sum += static_cast<uint32_t>(data[size - 1]) << 8;
+		}
+
+		return sum;
+	}
+
+	/// @brief 折叠到 16 位并取反，得到要写入报文的校验和。
+	/// @param sum
+	/// @return
+	inline uint16_t FinishChecksum(uint32_t sum)
+	{
+		while ((sum >> 16) != 0)
+		{
+			sum = (sum & 0xffff) + (sum >> 16);
+		}
+
+		return static_cast<uint16_t>(~sum);
+	}
+
+	/// @brief 帧中 IPv4 报文的各个部分的位置。
+	class Ipv4FrameLayout
+	{
+	public:
+		uint8_t *_ip_header = nullptr;
+		int32_t _ip_header_size = 0;
+		uint8_t _protocol = 0;
+
+		/// @brief 分片的 IP 报文不包含完整的传输层报文，为空。
+		uint8_t *_payload = nullptr;
+		int32_t _payload_size = 0;
+
+		/// @brief 解析以太网帧。
+		/// @param frame
+		/// @param size
+		/// @return 不是完整的 IPv4 帧返回 false.
+		bool TryParse(uint8_t *frame, int32_t size)
+		{
+			if (size < EthernetHeaderSize + Ipv4HeaderSize || ReadUInt16(frame + 12) != EtherTypeIPv4)
+			{
+				return false;
+			}
+
+			_ip_header = frame + EthernetHeaderSize;
+			_ip_header_size = (_ip_header[0] & 0x0f) * 4;
+			int32_t total_size = ReadUInt16(_ip_header + 2);
+			if (_ip_header_size < Ipv4HeaderSize || total_size < _ip_header_size ||
+				EthernetHeaderSize + total_size > size)
+			{
+				return false;
+			}
+
+			_protocol = _ip_header[9];
+			bool fragmented = (ReadUInt16(_ip_header + 6) & 0x3fff) != 0;
+			if (!fragmented)
+			{
+				_payload = _ip_header + _ip_header_size;
+				_payload_size = total_size - _ip_header_size;
+			}
+
+			return true;
+		}
+
+		/// @brief 传输层校验和的伪首部部分。
+		/// @return
+		uint32_t PseudoHeaderSum() const
+		{
+			uint32_t sum = AddWords(_ip_header + 12, 8, 0);
+			sum += _protocol;
+			sum += static_cast<uint32_t>(_payload_size);
+			return sum;
+		}
+
+		/// @brief 传输层校验和字段的偏移量。
+		/// @return 不认识的协议，或报文太短，返回 -1.
+		int32_t ChecksumOffset() const
+		{
+			switch (_protocol)
+			{
+			case IpProtocolUdp:
+				{
+					return _payload_size >= UdpHeaderSize ? 6 : -1;
+				}
+			case IpProtocolTcp:
+				{
+					return _payload_size >= 20 ? 16 : -1;
+				}
+			case IpProtocolIcmp:
+				{
+					return _payload_size >= 4 ? 2 : -1;
+				}
+			default:
+				{
+					return -1;
+				}
+			}
+		}
+
+		/// @brief 计算传输层报文的校验和，计算时把校验和字段当作 0.
+		/// @return
+		uint16_t ComputePayloadChecksum() const
+		{
+			int32_t offset = ChecksumOffset();
+			uint8_t saved[2]{_payload[offset], _payload[offset + 1]};
+			_payload[offset] = 0;
+			_payload[offset + 1] = 0;
+
+			// ICMP 没有伪首部。
+			uint32_t sum = _protocol == IpProtocolIcmp ? 0 : PseudoHeaderSum();
+			uint16_t checksum = FinishChecksum(AddWords(_payload, _payload_size, sum));
+
+			_payload[offset] = saved[0];
+			_payload[offset + 1] = saved[1];
+			if (checksum == 0 && _protocol == IpProtocolUdp)
+			{
+				// UDP 用 0 表示没有校验和。
+				checksum = 0xffff;
+			}
+
+			return checksum;
+		}
+
+		/// @brief 检查 IP 首部的校验和。
+		/// @return
+		bool IpHeaderChecksumIsValid() const
+		{
+			return FinishChecksum(AddWords(_ip_header, _ip_header_size, 0)) == 0;
+		}
+
+		/// @brief 检查传输层报文的校验和。
+		/// @return 没有校验和，或不认识的协议，返回 true.
+		bool PayloadChecksumIsValid() const
+		{
+			int32_t offset = ChecksumOffset();
+			if (_payload == nullptr || offset < 0)
+			{
+				return true;
+			}
+
+			uint16_t checksum = ReadUInt16(_payload + offset);
+			if (checksum == 0 && _protocol == IpProtocolUdp)
+			{
+				return true;
+			}
+
+			return checksum == ComputePayloadChecksum();
+		}
+	};
+
+	/// @brief 构造一个 IPv4 UDP 帧，校验和都正确。
+	/// @param destination_mac
+	/// @param source_mac
+	/// @param source_ip_address
+	/// @param destination_ip_address
+	/// @param source_port
+	/// @param destination_port
+	/// @param payload_size
+	/// @return
+	inline std::vector<uint8_t> BuildUdpFrame(std::array<uint8_t, 6> const &destination_mac,
+											  std::array<uint8_t, 6> const &source_mac,
+											  std::array<uint8_t, 4> const &source_ip_address,
+											  std::array<uint8_t, 4> const &destination_ip_address,
+											  uint16_t source_port,
+											  uint16_t destination_port,
+											  int32_t payload_size)
+	{
+		int32_t ip_size = Ipv4HeaderSize + UdpHeaderSize + payload_size;
+		std::vector<uint8_t> frame(EthernetHeaderSize + ip_size);
+		uint8_t *p = frame.data();
+
+		std::memcpy(p, destination_mac.data(), 6);
+		std::memcpy(p + 6, source_mac.data(), 6);
+		WriteUInt16(p + 12, EtherTypeIPv4);
+
+		uint8_t *ip = p + EthernetHeaderSize;
+		ip[0] = 0x45;
+		WriteUInt16(ip + 2, static_cast<uint16_t>(ip_size));
+		ip[8] = 64;
+		ip[9] = IpProtocolUdp;
+		std::memcpy(ip + 12, source_ip_address.data(), 4);
+		std::memcpy(ip + 16, destination_ip_address.data(), 4);
+		WriteUInt16(ip + 10, FinishChecksum(AddWords(ip, Ipv4HeaderSize, 0)));
+
+		uint8_t *udp = ip + Ipv4HeaderSize;
+		WriteUInt16(udp, source_port);
+		WriteUInt16(udp + 2, destination_port);
+		WriteUInt16(udp + 4, static_cast<uint16_t>(UdpHeaderSize + payload_size));
+		for (int32_t i = 0; i < payload_size; i++)
+		{
+			udp[UdpHeaderSize + i] = static_cast<uint8_t>(i);
+		}
+
+		Ipv4FrameLayout layout{};
+		layout.TryParse(p, static_cast<int32_t>(frame.size()));
+		WriteUInt16(udp + 6, layout.ComputePayloadChecksum());
+		return frame;
+	}
+} // namespace lwip::test
@@ -0,0 +1,321 @@
+#pragma once
+#include "base/embedded/ethernet/IEthernetPort.h"
+#include "base/IEvent.h"
+#include "base/IIdToken.h"
+#include "EthernetFrame.h"
+#include "lwip-wrapper/IChecksumOffload.h"
+#include "lwip-wrapper/IFrameTimestamping.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace lwip::test
+{
+	/// @brief 最简单的事件。
+	/// @note 在持有锁时调用订阅者，所以 Unsubscribe 返回后订阅者不会再被调用。
+	template <typename... Args>
+	class InMemoryEvent :
+		public base::IEvent<Args...>
+	{
+	private:
+		class Token :
+			public base::IIdToken
+		{
+		};
+
+		class Subscriber
+		{
+		public:
+			std::shared_ptr<base::IIdToken> _token;
+			std::function<void(Args...)> _func;
+		};
+
+		std::mutex _lock;
+		std::vector<Subscriber> _subscribers;
+
+	public:
+		std::shared_ptr<base::IIdToken> Subscribe(std::function<void(Args...)> const &func) override
+		{
+			std::lock_guard l{_lock};
+			std::shared_ptr<base::IIdToken> token{new Token{}};
+			_subscribers.push_back(Subscriber{token, func});
+			return token;
+		}
+
+		void Unsubscribe(std::shared_ptr<base::IIdToken> const &token) override
+		{
+			std::lock_guard l{_lock};
+			std::erase_if(_subscribers,
+						  [&token](Subscriber const &subscriber)
+						  {
+							  return subscriber._token == token;
+						  });
+		}
+
+		/// @brief 调用所有订阅者。
+		/// @param args
+		/// @return 订阅者的个数。
+		size_t Invoke(Args... args)
+		{
+			std::lock_guard l{_lock};
+			for (Subscriber const &subscriber : _subscribers)
+			{
+				subscriber._func(args...);
+			}
+
+			return _subscribers.size();
+		}
+	};
+
+	/// @brief 在内存中收发的以太网端口，用于测试和性能测试。
+	/// @note 用 Receive 注入帧，模拟从网线上接收；用 SetSendingCallback 查看发出的帧。
+	/// 发出的帧不会同步交给另一个端口：lwip 在内核上下文中发送，同步输入另一张网卡可能
+	/// 重入内核锁。
+	///
+	/// @note 接收的帧先被拷贝到循环使用的固定缓冲区中，再交给订阅者，模拟 DMA 接收环：
+	/// 缓冲区在端口析构前一直有效，但会被后来的帧覆盖。
+	///
+	/// @note 模拟硬件的校验和卸载：卸载了生成的项目，发送时由本端口填写校验和；卸载了校验
+	/// 的项目，接收时由本端口检查，丢弃校验失败的帧。
+	class InMemoryEthernetPort final :
+		public base::ethernet::IEthernetPort,
+		public lwip::IChecksumOffload,
+		public lwip::IFrameTimestamping
+	{
+	private:
+		static constexpr int32_t ReceivingBufferSize = 1536;
+
+		std::vector<std::array<uint8_t, ReceivingBufferSize>> _receiving_buffers;
+		uint32_t _next_receiving_buffer = 0;
+		std::mutex _receiving_lock;
+		std::chrono::nanoseconds _receiving_timestamp{0};
+		std::chrono::nanoseconds _sending_timestamp{0};
+
+		std::vector<uint8_t> _sending_buffer;
+		std::mutex _sending_lock;
+		std::function<void(base::ReadOnlySpan const &)> _sending_callback;
+
+		base::Mac _mac;
+		lwip::ChecksumOffloadCapability _checksum_offload_capability{};
+
+		InMemoryEvent<base::ReadOnlySpan> _receiving_event;
+		InMemoryEvent<> _connected_event;
+		InMemoryEvent<> _disconnected_event;
+
+		std::atomic_uint64_t _sent_frame_count = 0;
+		std::atomic_uint64_t _received_frame_count = 0;
+		std::atomic_uint64_t _dropped_frame_count = 0;
+
+		static std::chrono::nanoseconds Now()
+		{
+			return std::chrono::steady_clock::now().time_since_epoch();
+		}
+
+		/// @brief 按卸载能力填写校验和。
+		void GenerateChecksums(uint8_t *frame, int32_t size)
+		{
+			lwip::test::Ipv4FrameLayout layout{};
+			if (!layout.TryParse(frame, size))
+			{
+				return;
+			}
+
+			lwip::ChecksumOffloadCapability const &capability = _checksum_offload_capability;
+			if (capability.ip_generation)
+			{
+				lwip::test::WriteUInt16(layout._ip_header + 10, 0);
+				lwip::test::WriteUInt16(layout._ip_header + 10,
+										lwip::test::FinishChecksum(lwip::test::AddWords(layout._ip_header,
+																						layout._ip_header_size,
+																						0)));
+			}
+
+			bool generation = (layout._protocol == IpProtocolUdp && capability.udp_generation) ||
+							  (layout._protocol == IpProtocolTcp && capability.tcp_generation) ||
+							  (layout._protocol == IpProtocolIcmp && capability.icmp_generation);
+
+			int32_t offset = layout.ChecksumOffset();
+			if (generation && layout._payload != nullptr && offset >= 0)
+			{
+				lwip::test::WriteUInt16(layout._payload + offset, layout.ComputePayloadChecksum());
+			}
+		}
+
+		/// @brief 按卸载能力检查校验和。
+		/// @return 校验失败返回 false.
+		bool CheckChecksums(uint8_t *frame, int32_t size)
+		{
+			lwip::test::Ipv4FrameLayout layout{};
+			if (!layout.TryParse(frame, size))
+			{
+				return true;
+			}
+
+			lwip::ChecksumOffloadCapability const &capability = _checksum_offload_capability;
+			if (capability.ip_checking && !layout.IpHeaderChecksumIsValid())
+			{
+				return false;
+			}
+
+			bool checking = (layout._protocol == IpProtocolUdp && capability.udp_checking) ||
+							(layout._protocol == IpProtocolTcp && capability.tcp_checking) ||
+							(layout._protocol == IpProtocolIcmp && capability.icmp_checking);
+
+			return !checking || layout.PayloadChecksumIsValid();
+		}
+
+	public:
+		/// @brief 构造函数。
+		/// @param receiving_buffer_count 接收缓冲区的个数。lwip 暂存的接收 pbuf 比这个数多时，
+		/// 它们引用的数据会被新的帧覆盖。
+		InMemoryEthernetPort(uint32_t receiving_buffer_count = 4096)
+			: _receiving_buffers(receiving_buffer_count)
+		{
+		}
+
+		/// @brief 设置校验和卸载能力。在 NetifWrapper 打开之前设置。
+		/// @param value
+		void SetChecksumOffloadCapability(lwip::ChecksumOffloadCapability const &value)
+		{
+			_checksum_offload_capability = value;
+		}
+
+		/// @brief 设置发送帧时的回调。在填写了卸载的校验和之后调用。
+		/// @note 回调在 lwip 的发送路径上执行，通常处于 lwip 内核上下文，禁止阻塞。
+		/// @param callback
+		void SetSendingCallback(std::function<void(base::ReadOnlySpan const &)> callback)
+		{
+			std::lock_guard l{_sending_lock};
+			_sending_callback = std::move(callback);
+		}
+
+		/// @brief 通知订阅者链路接通。
+		void LinkUp()
+		{
+			_connected_event.Invoke();
+		}
+
+		/// @brief 通知订阅者链路断开。
+		void LinkDown()
+		{
+			_disconnected_event.Invoke();
+		}
+
+		/// @brief 从网线上接收一个帧。
+		/// @param frame
+		/// @return 帧被交给了订阅者返回 true. 校验失败，太长，或没有订阅者时返回 false.
+		bool Receive(base::ReadOnlySpan const &frame)
+		{
+			std::lock_guard l{_receiving_lock};
+			if (frame.Size() > ReceivingBufferSize)
+			{
+				_dropped_frame_count++;
+				return false;
+			}
+
+			std::array<uint8_t, ReceivingBufferSize> &buffer = _receiving_buffers[_next_receiving_buffer];
+			_next_receiving_buffer = (_next_receiving_buffer + 1) % _receiving_buffers.size();
+			std::memcpy(buffer.data(), frame.Buffer(), frame.Size());
+			if (!CheckChecksums(buffer.data(), frame.Size()))
+			{
+				_dropped_frame_count++;
+				return false;
+			}
+
+			_receiving_timestamp = Now();
+			if (_receiving_event.Invoke(base::ReadOnlySpan{buffer.data(), frame.Size()}) == 0)
+			{
+				_dropped_frame_count++;
+				return false;
+			}
+
+			_received_frame_count++;
+			return true;
+		}
+
+		uint64_t SentFrameCount() const
+		{
+			return _sent_frame_count;
+		}
+
+		uint64_t ReceivedFrameCount() const
+		{
+			return _received_frame_count;
+		}
+
+		uint64_t DroppedFrameCount() const
+		{
+			return _dropped_frame_count;
+		}
+
+#pragma region IEthernetPort
+		void Open(base::Mac const &mac) override
+		{
+			_mac = mac;
+		}
+
+		void Send(std::vector<base::ReadOnlySpan> const &spans) override
+		{
+			std::lock_guard l{_sending_lock};
+			_sending_buffer.clear();
+			for (base::ReadOnlySpan const &span : spans)
+			{
+				_sending_buffer.insert(_sending_buffer.end(), span.Buffer(), span.Buffer() + span.Size());
+			}
+
+			int32_t size = static_cast<int32_t>(_sending_buffer.size());
+			GenerateChecksums(_sending_buffer.data(), size);
+			_sending_timestamp = Now();
+			_sent_frame_count++;
+
+			base::ReadOnlySpan frame{_sending_buffer.data(), size};
+			if (_sending_callback != nullptr)
+			{
+				_sending_callback(frame);
+			}
+		}
+
+		base::IEvent<base::ReadOnlySpan> &ReceivingEhternetFrameEvent() override
+		{
+			return _receiving_event;
+		}
+
+		base::IEvent<> &ConnectedEvent() override
+		{
+			return _connected_event;
+		}
+
+		base::IEvent<> &DisconnectedEvent() override
+		{
+			return _disconnected_event;
+		}
+#pragma endregion
+
+#pragma region IChecksumOffload
+		lwip::ChecksumOffloadCapability ChecksumOffloadCapability() const override
+		{
+			return _checksum_offload_capability;
+		}
+#pragma endregion
+
+#pragma region IFrameTimestamping
+		bool TryGetReceivingTimestamp(std::chrono::nanoseconds &timestamp) override
+		{
+			// 在接收事件的回调中调用，这时持有 _receiving_lock.
+			timestamp = _receiving_timestamp;
+			return true;
+		}
+
+		bool TryGetSendingTimestamp(std::chrono::nanoseconds &timestamp) override
+		{
+			// 在 Send 返回后由同一个线程调用。lwip 在内核上下文中发送，不会并发。
+			timestamp = _sending_timestamp;
+			return true;
+		}
+#pragma endregion
+	};
+} // namespace lwip::test
@@ -0,0 +1,149 @@
+#include "lwip-wrapper/MacLearningTable.h"
+#include "TestHelper.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t Capacity = 8;
+	constexpr uint32_t AgingTime = 1000;
+
+	using Mac = std::array<uint8_t, 6>;
+
+	/// @brief 与 MacLearningTable 相同的哈希，用来构造起始位置相同的 MAC 地址。
+	/// @param key MAC 地址按大端序组成的整数。
+	/// @return
+	uint32_t HomeIndex(uint64_t key)
+	{
+		return static_cast<uint32_t>((key * 0x9e3779b97f4a7c15ull) >> 32) & (Capacity - 1);
+	}
+
+	Mac ToMac(uint64_t key)
+	{
+		Mac mac{};
+		for (int i = 5; i >= 0; i--)
+		{
+			mac[i] = static_cast<uint8_t>(key);
+			key >>= 8;
+		}
+
+		return mac;
+	}
+
+	/// @brief 找出 count 个起始位置都是 home 的 MAC 地址。
+	/// @param home
+	/// @param count
+	/// @param first 从这个值开始找，避免与已经找过的地址重复。
+	/// @return
+	std::vector<Mac> MacsAt(uint32_t home, int count, uint64_t first = 0x020000000001ull)
+	{
+		std::vector<Mac> macs;
+		for (uint64_t key = first; static_cast<int>(macs.size()) < count; key++)
+		{
+			if (HomeIndex(key) == home)
+			{
+				macs.push_back(ToMac(key));
+			}
+		}
+
+		return macs;
+	}
+
+	void CheckPort(lwip::MacLearningTable const &table, Mac const &mac, int32_t port, uint32_t now)
+	{
+		int32_t found = table.Find(mac.data(), now);
+		lwip::test::Check(found == port,
+						  "MAC 地址 " + std::to_string(mac[5]) + " 的端口应该是 " + std::to_string(port) +
+							  ", 实际是 " + std::to_string(found) + ".");
+	}
+
+	/// @brief 跨过表尾的探测链中间的地址被遗忘后，后面的地址仍然能查到，空出的位置可以复用。
+	void ForgetInsideWrappedCluster()
+	{
+		lwip::MacLearningTable table{Capacity, AgingTime};
+
+		// 三个地址从最后一个位置开始，占据 7, 0, 1.
+		std::vector<Mac> cluster = MacsAt(Capacity - 1, 4);
+		table.Learn(cluster[0].data(), 0, 0);
+		table.Learn(cluster[1].data(), 1, 0);
+		table.Learn(cluster[2].data(), 2, 0);
+		CheckPort(table, cluster[0], 0, 0);
+		CheckPort(table, cluster[1], 1, 0);
+		CheckPort(table, cluster[2], 2, 0);
+
+		table.Forget(1);
+		CheckPort(table, cluster[1], -1, 0);
+		CheckPort(table, cluster[0], 0, 0);
+		CheckPort(table, cluster[2], 2, 0);
+
+		// 新地址复用被遗忘的位置，不截断后面的探测链。
+		table.Learn(cluster[3].data(), 3, 0);
+		CheckPort(table, cluster[3], 3, 0);
+		CheckPort(table, cluster[2], 2, 0);
+
+		// 被遗忘的地址重新出现时可以再学习。
+		table.Learn(cluster[1].data(), 1, 0);
+		CheckPort(table, cluster[1], 1, 0);
+	}
+
+	/// @brief 超过老化时间后查不到，刷新后重新生效；主机换端口后查到新端口。
+	void Expire()
+	{
+		lwip::MacLearningTable table{Capacity, AgingTime};
+		Mac mac = MacsAt(0, 1)[0];
+
+		table.Learn(mac.data(), 5, 0);
+		CheckPort(table, mac, 5, AgingTime);
+		CheckPort(table, mac, -1, AgingTime + 1);
+
+		table.Learn(mac.data(), 6, AgingTime * 2);
+		CheckPort(table, mac, 6, AgingTime * 2);
+
+		// 时间戳回绕后，间隔仍然正确。
+		table.Learn(mac.data(), 7, UINT32_MAX - 10);
+		CheckPort(table, mac, 7, 10);
+	}
+
+	/// @brief 探测范围内全是活跃的表项时放弃学习，表项老化后可以学习。
+	void Full()
+	{
+		lwip::MacLearningTable table{Capacity, AgingTime};
+		std::vector<Mac> macs = MacsAt(0, Capacity + 1);
+		for (uint32_t i = 0; i < Capacity; i++)
+		{
+			table.Learn(macs[i].data(), static_cast<uint16_t>(i), 0);
+		}
+
+		table.Learn(macs[Capacity].data(), Capacity, 0);
+		CheckPort(table, macs[Capacity], -1, 0);
+		for (uint32_t i = 0; i < Capacity; i++)
+		{
+			CheckPort(table, macs[i], static_cast<int32_t>(i), 0);
+		}
+
+		// 只刷新第一个，其余的都老化了。
+		table.Learn(macs[0].data(), 0, AgingTime * 2);
+		table.Learn(macs[Capacity].data(), Capacity, AgingTime * 2);
+		CheckPort(table, macs[Capacity], Capacity, AgingTime * 2);
+		CheckPort(table, macs[0], 0, AgingTime * 2);
+
+		table.Clear();
+		for (uint32_t i = 0; i <= Capacity; i++)
+		{
+			CheckPort(table, macs[i], -1, AgingTime * 2);
+		}
+	}
+
+	void TestMacLearningTable()
+	{
+		ForgetInsideWrappedCluster();
+		Expire();
+		Full();
+	}
+} // namespace
+
+int main()
+{
+	return lwip::test::Run("MacLearningTable", TestMacLearningTable);
+}
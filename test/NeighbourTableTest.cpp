@@ -0,0 +1,194 @@
+#include "lwip-wrapper/NeighbourTable.h"
+#include "TestHelper.h"
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t Capacity = 8;
+	constexpr uint32_t AgingTime = 1000;
+
+	/// @brief 与 NeighbourTable 相同的哈希，用来构造起始位置相同的地址。
+	/// @param ip
+	/// @return
+	uint32_t HomeIndex(uint32_t ip)
+	{
+		return ((ip * 0x9e3779b1u) >> 16) & (Capacity - 1);
+	}
+
+	/// @brief 找出 count 个起始位置都是 home 的地址。
+	/// @param home
+	/// @param count
+	/// @param first 从这个值开始找，避免与已经找过的地址重复。
+	/// @return
+	std::vector<ip4_addr_t> AddressesAt(uint32_t home, int count, uint32_t first = 1)
+	{
+		std::vector<ip4_addr_t> addresses;
+		for (uint32_t ip = first; static_cast<int>(addresses.size()) < count; ip++)
+		{
+			if (HomeIndex(ip) == home)
+			{
+				ip4_addr_t address{};
+				address.addr = ip;
+				addresses.push_back(address);
+			}
+		}
+
+		return addresses;
+	}
+
+	eth_addr MakeMac(uint8_t last)
+	{
+		eth_addr mac{};
+		mac.addr[0] = 0x02;
+		mac.addr[5] = last;
+		return mac;
+	}
+
+	/// @brief 检查地址能查到，并且 MAC 地址的最后一个字节是 last.
+	void CheckFound(lwip::NeighbourTable &table, ip4_addr_t const &address, uint8_t last, uint32_t now)
+	{
+		eth_addr const *mac = table.Find(address, now);
+		lwip::test::Check(mac != nullptr, "地址 " + std::to_string(address.addr) + " 查不到。");
+		lwip::test::Check(mac->addr[5] == last, "地址 " + std::to_string(address.addr) + " 的 MAC 地址错误。");
+	}
+
+	void CheckNotFound(lwip::NeighbourTable &table, ip4_addr_t const &address, uint32_t now)
+	{
+		lwip::test::Check(table.Find(address, now) == nullptr,
+						  "地址 " + std::to_string(address.addr) + " 不应该查到。");
+	}
+
+	/// @brief 在跨过表尾的探测链中间删除，后面的表项要移过来填补空位，仍然都能查到。
+	void RemoveInsideWrappedCluster()
+	{
+		lwip::NeighbourTable table{Capacity, AgingTime};
+
+		// a, b, c 从倒数第二个位置开始，占据 6, 7, 0. d 从 7 开始，被挤到 1.
+		std::vector<ip4_addr_t> cluster = AddressesAt(Capacity - 2, 3);
+		ip4_addr_t d = AddressesAt(Capacity - 1, 1)[0];
+		for (int i = 0; i < 3; i++)
+		{
+			table.Learn(cluster[i], MakeMac(static_cast<uint8_t>(i)), 0, false);
+		}
+
+		table.Learn(d, MakeMac(3), 0, false);
+
+		lwip::test::Check(table.Remove(cluster[1]), "删除探测链中间的表项失败。");
+		CheckNotFound(table, cluster[1], 0);
+		CheckFound(table, cluster[0], 0, 0);
+		CheckFound(table, cluster[2], 2, 0);
+		CheckFound(table, d, 3, 0);
+
+		lwip::test::Check(table.Remove(cluster[0]), "删除探测链开头的表项失败。");
+		CheckFound(table, cluster[2], 2, 0);
+		CheckFound(table, d, 3, 0);
+
+		lwip::test::Check(!table.Remove(cluster[0]), "重复删除应该返回 false.");
+
+		// 删除后空出来的位置可以再次学习。
+		table.Learn(cluster[1], MakeMac(1), 0, false);
+		CheckFound(table, cluster[1], 1, 0);
+		CheckFound(table, cluster[2], 2, 0);
+		CheckFound(table, d, 3, 0);
+		lwip::test::Check(table.Statistics().eviction_count == 0, "表没有满，不应该挤出表项。");
+	}
+
+	/// @brief 动态表项超过老化时间后查不到，位置可以被重新利用；静态表项不老化。
+	void Expire()
+	{
+		lwip::NeighbourTable table{Capacity, AgingTime};
+		std::vector<ip4_addr_t> addresses = AddressesAt(0, 3);
+
+		table.Learn(addresses[0], MakeMac(0), 0, false);
+		table.Learn(addresses[1], MakeMac(1), 0, true);
+
+		CheckFound(table, addresses[0], 0, AgingTime);
+		CheckNotFound(table, addresses[0], AgingTime + 1);
+		CheckFound(table, addresses[1], 1, AgingTime * 100);
+
+		// 时间戳回绕后，间隔仍然正确。
+		table.Learn(addresses[2], MakeMac(2), UINT32_MAX - 10, false);
+		CheckFound(table, addresses[2], 2, 10);
+
+		// 老化的表项被新地址覆盖，不算挤出。
+		std::vector<ip4_addr_t> more = AddressesAt(0, Capacity - 2, addresses[2].addr + 1);
+		for (size_t i = 0; i < more.size(); i++)
+		{
+			table.Learn(more[i], MakeMac(static_cast<uint8_t>(10 + i)), AgingTime * 2, false);
+		}
+
+		lwip::test::Check(table.Statistics().eviction_count == 0, "覆盖老化的表项不应该算作挤出。");
+		CheckNotFound(table, addresses[0], AgingTime * 2);
+		CheckFound(table, addresses[1], 1, AgingTime * 2);
+		for (size_t i = 0; i < more.size(); i++)
+		{
+			CheckFound(table, more[i], static_cast<uint8_t>(10 + i), AgingTime * 2);
+		}
+	}
+
+	/// @brief 表满时挤出最久没有刷新的动态表项；全是静态表项时放弃学习。
+	void Full()
+	{
+		std::vector<ip4_addr_t> addresses = AddressesAt(0, Capacity + 1);
+
+		lwip::NeighbourTable table{Capacity, AgingTime};
+		for (uint32_t i = 0; i < Capacity; i++)
+		{
+			table.Learn(addresses[i], MakeMac(static_cast<uint8_t>(i)), i, false);
+		}
+
+		table.Learn(addresses[Capacity], MakeMac(Capacity), Capacity, false);
+		lwip::test::Check(table.Statistics().eviction_count == 1, "表满时应该挤出一个表项。");
+		CheckNotFound(table, addresses[0], Capacity);
+		for (uint32_t i = 1; i <= Capacity; i++)
+		{
+			CheckFound(table, addresses[i], static_cast<uint8_t>(i), Capacity);
+		}
+
+		lwip::NeighbourTable static_table{Capacity, AgingTime};
+		for (uint32_t i = 0; i < Capacity; i++)
+		{
+			static_table.Learn(addresses[i], MakeMac(static_cast<uint8_t>(i)), 0, true);
+		}
+
+		static_table.Learn(addresses[Capacity], MakeMac(Capacity), 0, false);
+		lwip::test::Check(static_table.Statistics().eviction_count == 0, "静态表项不能被挤出。");
+		CheckNotFound(static_table, addresses[Capacity], 0);
+		for (uint32_t i = 0; i < Capacity; i++)
+		{
+			CheckFound(static_table, addresses[i], static_cast<uint8_t>(i), AgingTime * 100);
+		}
+	}
+
+	/// @brief Refresh 只刷新已有的动态表项。
+	void Refresh()
+	{
+		lwip::NeighbourTable table{Capacity, AgingTime};
+		std::vector<ip4_addr_t> addresses = AddressesAt(0, 3);
+
+		lwip::test::Check(!table.Refresh(addresses[0], MakeMac(0), 0), "Refresh 不应该插入表项。");
+		CheckNotFound(table, addresses[0], 0);
+
+		table.Learn(addresses[1], MakeMac(1), 0, false);
+		lwip::test::Check(table.Refresh(addresses[1], MakeMac(11), AgingTime), "Refresh 已有的表项失败。");
+		CheckFound(table, addresses[1], 11, AgingTime * 2);
+
+		table.Learn(addresses[2], MakeMac(2), 0, true);
+		lwip::test::Check(!table.Refresh(addresses[2], MakeMac(12), 0), "Refresh 不应该修改静态表项。");
+		CheckFound(table, addresses[2], 2, 0);
+	}
+
+	void TestNeighbourTable()
+	{
+		RemoveInsideWrappedCluster();
+		Expire();
+		Full();
+		Refresh();
+	}
+} // namespace
+
+int main()
+{
+	return lwip::test::Run("NeighbourTable", TestNeighbourTable);
+}
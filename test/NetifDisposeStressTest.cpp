@@ -0,0 +1,104 @@
+#include "base/task/delay.h"
+#include "EthernetFrame.h"
+#include "InMemoryEthernetPort.h"
+#include "lwip-wrapper/NetifWrapper.h"
+#include "TestHelper.h"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace
+{
+	constexpr int Iterations = 20;
+
+	std::array<uint8_t, 6> const LocalMac{0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+	std::array<uint8_t, 6> const RemoteMac{0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+	std::array<uint8_t, 4> const LocalIPAddress{192, 168, 100, 1};
+	std::array<uint8_t, 4> const RemoteIPAddress{192, 168, 100, 2};
+
+	/// @brief 一边以最快的速度接收和发送，一边反复打开和释放网卡。
+	/// @note 每轮释放后检查接收 pbuf 全部被释放，最后端口析构时不能有 pbuf 引用它的内存。
+	/// 用 AddressSanitizer 构建时可以发现释放后使用。
+	void Stress()
+	{
+		// 端口要比所有网卡活得久。
+		lwip::test::InMemoryEthernetPort port{};
+
+		// 收到的帧发给本网卡没有监听的端口，lwip 会回复 ICMP 端口不可达，也会走发送路径。
+		std::vector<uint8_t> frame = lwip::test::BuildUdpFrame(LocalMac,
+															   RemoteMac,
+															   RemoteIPAddress,
+															   LocalIPAddress,
+															   50000,
+															   9,
+															   64);
+
+		std::atomic_bool stopped = false;
+		std::thread receiving_thread{
+			[&]()
+			{
+				while (!stopped)
+				{
+					port.Receive(base::ReadOnlySpan{frame.data(), static_cast<int32_t>(frame.size())});
+				}
+			},
+		};
+
+		std::mt19937 random{20261018};
+		for (int i = 0; i < Iterations; i++)
+		{
+			std::unique_ptr<lwip::NetifWrapper> netif{new lwip::NetifWrapper{"stress" + std::to_string(i)}};
+			netif->Open(&port,
+						lwip::test::MakeMac(LocalMac),
+						lwip::test::MakeIPAddress(LocalIPAddress),
+						lwip::test::MakeIPAddress({255, 255, 255, 0}),
+						lwip::test::MakeIPAddress({192, 168, 100, 254}),
+						1500);
+
+			port.LinkUp();
+
+			// 释放期间还在发送的线程。释放后 SendFrame 会抛出异常，这是预期的。
+			std::atomic_bool sending_stopped = false;
+			std::thread sending_thread{
+				[&]()
+				{
+					while (!sending_stopped)
+					{
+						try
+						{
+							netif->SendFrame(base::ReadOnlySpan{frame.data(), static_cast<int32_t>(frame.size())});
+						}
+						catch (std::exception const &e)
+						{
+						}
+					}
+				},
+			};
+
+			base::task::Delay(std::chrono::milliseconds{random() % 20});
+			netif->Dispose();
+
+			sending_stopped = true;
+			sending_thread.join();
+
+			lwip::test::Check(netif->OutstandingInputPbufCount() == 0,
+							  "第 " + std::to_string(i) + " 轮释放后还有 " +
+								  std::to_string(netif->OutstandingInputPbufCount()) + " 个接收 pbuf 没有释放。");
+
+			netif.reset();
+		}
+
+		stopped = true;
+		receiving_thread.join();
+
+		lwip::test::Check(port.ReceivedFrameCount() > 0, "没有帧被交给网卡。");
+		lwip::test::Check(port.SentFrameCount() > 0, "网卡没有发送帧。");
+	}
+} // namespace
+
+int main()
+{
+	return lwip::test::Run("NetifWrapper: 收发期间反复打开和释放", Stress);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+namespace lwip::test
+{
+	/// @brief lwip 的 inet_chksum.c 中 LWIP_CHKSUM_ALGORITHM == 2 的 lwip_standard_chksum.
+	/// @note lwipopts.h 把 LWIP_CHKSUM 换成 lwip_wrapper_chksum 后，lwip 不再编译它自己的
+	/// 版本，所以这里逐行照抄一份作为参照。32 位累加和在超过 128 KiB 时会溢出，与原版相同。
+	/// @param dataptr
+	/// @param len
+	/// @return
+	inline uint16_t lwip_standard_chksum(void const *dataptr, int len)
+	{
+		uint8_t const *pb = reinterpret_cast<uint8_t const *>(dataptr);
+		uint16_t const *ps;
+		uint16_t t = 0;
+		uint32_t sum = 0;
+		int odd = (reinterpret_cast<uintptr_t>(pb) & 1);
+
+		/* Get aligned to u16_t */
+		if (odd && len > 0)
+		{
+			reinterpret_cast<uint8_t *>(&t)[1] = *pb++;
+			len--;
+		}
+
+		/* Add the bulk of the data */
+		ps = reinterpret_cast<uint16_t const *>(pb);
+		while (len > 1)
+		{
+			sum += *ps++;
+			len -= 2;
+		}
+
+		/* Consume left-over byte, if any */
+		if (len > 0)
+		{
+			reinterpret_cast<uint8_t *>(&t)[0] = *reinterpret_cast<uint8_t const *>(ps);
+		}
+
+		/* Add end bytes */
+		sum += t;
+
+		/* Fold 32-bit sum to 16 bits */
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum = (sum >> 16) + (sum & 0xffff);
+
+		/* Swap if alignment was odd */
+		if (odd)
+		{
+			sum = ((sum & 0xff) << 8) | ((sum & 0xff00) >> 8);
+		}
+
+		return static_cast<uint16_t>(sum);
+	}
+} // namespace lwip::test
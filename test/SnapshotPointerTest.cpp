@@ -0,0 +1,81 @@
+#include "lwip-wrapper/SnapshotPointer.h"
+#include "TestHelper.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/// @brief 两个字段总是互为按位取反。读到被释放或写了一半的快照时不成立。
+	class Value
+	{
+	public:
+		uint64_t _value = 0;
+		uint64_t _inverted_value = ~uint64_t{0};
+	};
+
+	/// @brief 多个读者不停地 Load, 写者连续地 Store, 读者每次都检查快照的完整性。
+	void LoadAgainstBackToBackStores()
+	{
+		constexpr int ReaderCount = 4;
+		constexpr uint64_t StoreCount = 2000;
+
+		lwip::SnapshotPointer<Value> pointer;
+		std::atomic_bool stop = false;
+		std::atomic_uint64_t corrupted_count = 0;
+		std::atomic_uint64_t load_count = 0;
+
+		std::vector<std::thread> readers;
+		for (int i = 0; i < ReaderCount; i++)
+		{
+			readers.emplace_back(
+				[&]()
+				{
+					uint64_t last_value = 0;
+					while (!stop)
+					{
+						std::shared_ptr<Value const> value = pointer.Load();
+						if (value->_inverted_value != ~value->_value || value->_value < last_value)
+						{
+							corrupted_count++;
+						}
+
+						last_value = value->_value;
+						load_count++;
+					}
+				});
+		}
+
+		// 等读者都跑起来再开始写。
+		while (load_count < ReaderCount)
+		{
+			std::this_thread::yield();
+		}
+
+		for (uint64_t i = 1; i <= StoreCount; i++)
+		{
+			std::shared_ptr<Value> value{new Value{}};
+			value->_value = i;
+			value->_inverted_value = ~i;
+			pointer.Store(value);
+
+			// 让出处理器，让读者有机会停在 Load 的中间。
+			std::this_thread::yield();
+		}
+
+		stop = true;
+		for (std::thread &reader : readers)
+		{
+			reader.join();
+		}
+
+		lwip::test::Check(corrupted_count == 0, "读到了被释放或不完整的快照。");
+		lwip::test::Check(load_count > 0, "读者没有运行。");
+		lwip::test::Check(pointer.Load()->_value == StoreCount, "最后的快照不是最后一次 Store 的值。");
+	}
+} // namespace
+
+int main()
+{
+	return lwip::test::Run("SnapshotPointer: Load 与连续的 Store 并发", LoadAgainstBackToBackStores);
+}
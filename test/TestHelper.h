@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdio>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace lwip::test
+{
+	/// @brief 条件不成立时抛出异常，由 Run 捕获并让测试失败。
+	/// @param condition
+	/// @param message
+	inline void Check(bool condition, std::string const &message)
+	{
+		if (!condition)
+		{
+			throw std::runtime_error{message};
+		}
+	}
+
+	/// @brief 执行测试函数，返回进程的退出码。
+	/// @param name 测试的名称。
+	/// @param func
+	/// @return 通过返回 0, 失败返回 1.
+	inline int Run(std::string const &name, std::function<void()> const &func)
+	{
+		try
+		{
+			func();
+			std::printf("[通过] %s\n", name.c_str());
+			return 0;
+		}
+		catch (std::exception const &e)
+		{
+			std::printf("[失败] %s: %s\n", name.c_str(), e.what());
+			return 1;
+		}
+	}
+} // namespace lwip::test
@@ -0,0 +1,17 @@
+# 测试。每个测试是一个独立的可执行文件，返回 0 表示通过。
+enable_testing()
+set(LWIP_WRAPPER_TEST_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(lwip_wrapper_add_test name)
+	add_executable(${name} ${LWIP_WRAPPER_TEST_DIR}/${name}.cpp)
+	target_link_libraries(${name} PRIVATE ${ProjectName})
+	target_include_directories(${name} PRIVATE ${LWIP_WRAPPER_TEST_DIR})
+	add_test(NAME ${name} COMMAND ${name})
+endfunction()
+
+lwip_wrapper_add_test(SnapshotPointerTest)
+lwip_wrapper_add_test(ChecksumTest)
+lwip_wrapper_add_test(NetifDisposeStressTest)
+lwip_wrapper_add_test(ChecksumOffloadTest)
+lwip_wrapper_add_test(NeighbourTableTest)
+lwip_wrapper_add_test(MacLearningTableTest)